@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+# Headless bot load test for the NS dedicated server.
+#
+# Starts a -server -nullrhi instance on loopback, connects N -NSBot clients,
+# and lets the server append one CSV row per window (see ANSLoadTestRecorder).
+# Runs once per player count. Needs no GPU.
+#
+# Usage: UE4_EDITOR=/path/to/UE4Editor Scripts/run_bot_load_test.sh [counts...]
+#   counts   player counts to test (default: 16 32 64 128)
+#
+# Environment:
+#   UE4_EDITOR   UE4Editor binary (required)
+#   DURATION     seconds to record per player count (default: 120)
+#   WARMUP       seconds to wait after the last bot joins (default: 15)
+#   WINDOW       seconds per CSV row (default: 10)
+#   PORT         server port (default: 7777)
+#   OUT_DIR      where CSVs and logs go (default: Saved/LoadTest)
+#   SERVER_EXEC  console commands the server runs at startup, e.g.
+#                "ns.TeamRelevancy 0" to record a default-relevancy baseline
+#   COMPARE_RELEVANCY
+#                if set, runs each count twice: server_<N>_baseline.csv with
+#                ns.TeamRelevancy 0, then server_<N>_team.csv with it on.
+#                Compare the tick percentile columns (they include the net
+#                broadcast tick) to get the before/after relevancy cost
+
+set -euo pipefail
+
+if [[ -z "${UE4_EDITOR:-}" ]]; then
+	echo "UE4_EDITOR must point at the UE4Editor binary" >&2
+	exit 1
+fi
+
+PROJECT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+PROJECT="$PROJECT_DIR/NS.uproject"
+MAP="/Game/FirstPersonCPP/Maps/FirstPersonExampleMap"
+DURATION="${DURATION:-120}"
+WARMUP="${WARMUP:-15}"
+WINDOW="${WINDOW:-10}"
+PORT="${PORT:-7777}"
+OUT_DIR="${OUT_DIR:-$PROJECT_DIR/Saved/LoadTest}"
+COUNTS=("$@")
+if [[ ${#COUNTS[@]} -eq 0 ]]; then
+	COUNTS=(16 32 64 128)
+fi
+
+mkdir -p "$OUT_DIR"
+
+PIDS=()
+cleanup() {
+	for pid in "${PIDS[@]:-}"; do
+		kill "$pid" 2>/dev/null || true
+	done
+	wait 2>/dev/null || true
+	PIDS=()
+}
+trap cleanup EXIT INT TERM
+
+# run_one <count> <name suffix> <server exec commands>
+run_one() {
+	local count="$1" suffix="$2" exec_cmds="$3"
+	local csv="$OUT_DIR/server_${count}${suffix}.csv"
+	rm -f "$csv"
+	echo "== $count players -> $csv"
+
+	"$UE4_EDITOR" "$PROJECT" "$MAP?Listen" -server -nullrhi -nosound -unattended -port="$PORT" \
+		-NSLoadTestCsv="$csv" -NSLoadTestWindow="$WINDOW" -ExecCmds="$exec_cmds" \
+		-abslog="$OUT_DIR/server_${count}${suffix}.log" >/dev/null 2>&1 &
+	PIDS+=($!)
+	sleep 20
+
+	for ((i = 0; i < count; i++)); do
+		"$UE4_EDITOR" "$PROJECT" "127.0.0.1:$PORT" -game -nullrhi -nosound -unattended -NSBot \
+			-abslog="$OUT_DIR/bot_${count}${suffix}_${i}.log" >/dev/null 2>&1 &
+		PIDS+=($!)
+		# Stagger joins so the server is not hit by every handshake at once
+		sleep 0.2
+	done
+
+	sleep "$WARMUP"
+	# Drop rows recorded while bots were still joining
+	if [[ -f "$csv" ]]; then
+		head -n 1 "$csv" > "$csv.tmp" && mv "$csv.tmp" "$csv"
+	fi
+	sleep "$DURATION"
+
+	cleanup
+	sleep 5
+}
+
+for count in "${COUNTS[@]}"; do
+	if [[ -n "${COMPARE_RELEVANCY:-}" ]]; then
+		run_one "$count" "_baseline" "ns.TeamRelevancy 0${SERVER_EXEC:+,$SERVER_EXEC}"
+		run_one "$count" "_team" "ns.TeamRelevancy 1${SERVER_EXEC:+,$SERVER_EXEC}"
+	else
+		run_one "$count" "" "${SERVER_EXEC:-}"
+	fi
+done
+
+echo "CSV files:"
+ls -1 "$OUT_DIR"/server_*.csv
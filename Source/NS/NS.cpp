@@ -2,6 +2,207 @@
 
 #include "NS.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Components/ActorComponent.h"
+#include "UObject/Class.h"
+#include "NSAllocCounter.h"
+#include "NSTickAudit.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, NS, "NS" );
- 
\ No newline at end of file
+/** 개발 빌드에서는 시작할 때 할당 카운터를 끼운다. 빼지 않으니 ShutdownModule은 없다 */
+class FNSGameModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+#if !UE_BUILD_SHIPPING
+		FNSAllocCounter::Install();
+#endif
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FNSGameModule, NS, "NS" );
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorld NSListReplicatedActorsCommand(
+	TEXT("ns.ListReplicatedActors"),
+	TEXT("Lists replicated actor classes on the server with awake/dormant counts, open channels and an estimate of property comparisons per frame derived from NetUpdateFrequency. Nothing is timed; for measured per-class replication cost use 'netprofile' and the Network Profiler."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		if (NetDriver == nullptr || !NetDriver->IsServer()) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.ListReplicatedActors must run on a server"));
+			return;
+		}
+
+		struct FClassCost
+		{
+			int32 Awake = 0;
+			int32 Dormant = 0;
+			int32 Channels = 0;
+			float UpdatesPerSecond = 0.0f;
+		};
+		TMap<UClass*, FClassCost> Costs;
+
+		for (TActorIterator<AActor> Iter(World); Iter; ++Iter) {
+			AActor* Actor = *Iter;
+			if (!Actor->GetIsReplicated() || Actor->IsPendingKill()) {
+				continue;
+			}
+			FClassCost& Cost = Costs.FindOrAdd(Actor->GetClass());
+			if (Actor->NetDormancy > DORM_Awake) {
+				Cost.Dormant++;
+			}
+			else {
+				Cost.Awake++;
+				Cost.UpdatesPerSecond += Actor->NetUpdateFrequency;
+			}
+		}
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections) {
+			for (const auto& Pair : Connection->ActorChannels) {
+				AActor* Actor = Pair.Key.Get();
+				if (Actor) {
+					Costs.FindOrAdd(Actor->GetClass()).Channels++;
+				}
+			}
+		}
+
+		//깨어 있는 액터는 갱신 주기마다 연결마다 속성을 비교한다고 보고 어림한다. 적응형 갱신 빈도나 대역폭 포화로 건너뛴 갱신은 모른다
+		const int32 NumConnections = FMath::Max(NetDriver->ClientConnections.Num(), 1);
+		const float TickRate = FMath::Max(NetDriver->NetServerMaxTickRate, 1);
+		Costs.ValueSort([](const FClassCost& A, const FClassCost& B) { return A.UpdatesPerSecond > B.UpdatesPerSecond; });
+
+		UE_LOG(LogTemp, Display, TEXT("%-40s %6s %7s %8s %18s"), TEXT("Class"), TEXT("Awake"), TEXT("Dormant"), TEXT("Channels"), TEXT("Est.Compares/frame"));
+		for (const auto& Pair : Costs) {
+			const FClassCost& Cost = Pair.Value;
+			const float ComparesPerFrame = FMath::Min(Cost.UpdatesPerSecond / TickRate, (float)Cost.Awake) * NumConnections;
+			UE_LOG(LogTemp, Display, TEXT("%-40s %6d %7d %8d %18.1f"), *Pair.Key->GetName(), Cost.Awake, Cost.Dormant, Cost.Channels, ComparesPerFrame);
+		}
+		UE_LOG(LogTemp, Display, TEXT("%d connections, server tick rate %.0f. Est.Compares/frame is an upper bound from NetUpdateFrequency, not a measurement"),
+			NetDriver->ClientConnections.Num(), TickRate);
+	})
+);
+
+/** ns.TickAudit가 여러 프레임에 걸쳐 액터 틱 구간 전체 시간과 NS 액터의 틱마다 걸린 시간을 잰다 */
+struct FNSTickAuditTimer
+{
+	TWeakObjectPtr<UWorld> World;
+	int32 FramesLeft = 0;
+	int32 Frames = 0;
+	double StartTime = 0.0;
+	double TotalTime = 0.0;
+	double MaxTime = 0.0;
+	FDelegateHandle PreHandle;
+	FDelegateHandle PostHandle;
+
+	void Start(UWorld* InWorld, int32 NumFrames)
+	{
+		Stop();
+		World = InWorld;
+		FramesLeft = NumFrames;
+		Frames = 0;
+		TotalTime = 0.0;
+		MaxTime = 0.0;
+		PreHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FNSTickAuditTimer::OnPreActorTick);
+		PostHandle = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FNSTickAuditTimer::OnPostActorTick);
+		FNSTickAudit::Begin();
+	}
+
+	void Stop()
+	{
+		FNSTickAudit::End(Frames);
+		FWorldDelegates::OnWorldPreActorTick.Remove(PreHandle);
+		FWorldDelegates::OnWorldPostActorTick.Remove(PostHandle);
+		PreHandle.Reset();
+		PostHandle.Reset();
+	}
+
+	void OnPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+	{
+		if (InWorld == World.Get()) {
+			StartTime = FPlatformTime::Seconds();
+		}
+	}
+
+	void OnPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+	{
+		if (InWorld != World.Get()) {
+			return;
+		}
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+		TotalTime += Elapsed;
+		MaxTime = FMath::Max(MaxTime, Elapsed);
+		Frames++;
+		if (--FramesLeft <= 0) {
+			//틱 그룹 전체 구간이라 물리 대기 시간도 들어 있다
+			UE_LOG(LogTemp, Display, TEXT("ns.TickAudit: actor/component ticks avg %.3f ms, max %.3f ms over %d frames"),
+				TotalTime * 1000.0 / Frames, MaxTime * 1000.0, Frames);
+			Stop();
+		}
+	}
+};
+
+static FNSTickAuditTimer GNSTickAuditTimer;
+
+static FAutoConsoleCommandWithWorldAndArgs NSTickAuditCommand(
+	TEXT("ns.TickAudit"),
+	TEXT("Lists enabled actor and component tick functions by class with tick group and interval, then over Frames frames times the whole actor tick phase and each NS actor Tick by class. Engine classes are listed without a cost; use 'stat dumpframe -ms=0.1' for them. Args: [Frames=60]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) {
+			return;
+		}
+
+		struct FTickEntry
+		{
+			int32 Count = 0;
+			float MinInterval = MAX_FLT;
+		};
+		//클래스와 틱 그룹이 같은 틱 함수를 한 줄로 묶는다
+		TMap<FString, FTickEntry> Entries;
+		const UEnum* TickGroupEnum = FindObject<UEnum>(ANY_PACKAGE, TEXT("ETickingGroup"));
+		auto AddTick = [&Entries, TickGroupEnum](const TCHAR* Kind, UObject* Object, const FTickFunction& TickFunction)
+		{
+			const FString TickGroup = TickGroupEnum ? TickGroupEnum->GetNameStringByValue((int64)TickFunction.TickGroup) : FString::FromInt(TickFunction.TickGroup);
+			FTickEntry& Entry = Entries.FindOrAdd(FString::Printf(TEXT("%-9s %-40s %s"), Kind, *Object->GetClass()->GetName(), *TickGroup));
+			Entry.Count++;
+			Entry.MinInterval = FMath::Min(Entry.MinInterval, TickFunction.TickInterval);
+		};
+
+		int32 NumActors = 0;
+		int32 NumComponents = 0;
+		for (TActorIterator<AActor> Iter(World); Iter; ++Iter) {
+			AActor* Actor = *Iter;
+			if (Actor->PrimaryActorTick.IsTickFunctionRegistered() && Actor->PrimaryActorTick.IsTickFunctionEnabled()) {
+				AddTick(TEXT("Actor"), Actor, Actor->PrimaryActorTick);
+				NumActors++;
+			}
+			TInlineComponentArray<UActorComponent*> Components(Actor);
+			for (UActorComponent* Component : Components) {
+				if (Component->PrimaryComponentTick.IsTickFunctionRegistered() && Component->PrimaryComponentTick.IsTickFunctionEnabled()) {
+					AddTick(TEXT("Component"), Component, Component->PrimaryComponentTick);
+					NumComponents++;
+				}
+			}
+		}
+
+		Entries.ValueSort([](const FTickEntry& A, const FTickEntry& B) { return A.Count > B.Count; });
+		UE_LOG(LogTemp, Display, TEXT("%-9s %-40s %-20s %6s %9s"), TEXT("Kind"), TEXT("Class"), TEXT("TickGroup"), TEXT("Count"), TEXT("Interval"));
+		for (const auto& Pair : Entries) {
+			UE_LOG(LogTemp, Display, TEXT("%-71s %6d %9.3f"), *Pair.Key, Pair.Value.Count, Pair.Value.MinInterval);
+		}
+		UE_LOG(LogTemp, Display, TEXT("%d ticking actors, %d ticking components"), NumActors, NumComponents);
+
+		const int32 Frames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 60;
+		if (Frames > 0) {
+			GNSTickAuditTimer.Start(World, Frames);
+		}
+	})
+);
+
+#endif
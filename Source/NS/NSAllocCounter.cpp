@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSAllocCounter.h"
+#include "NS.h"
+#include "HAL/MemoryBase.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace
+{
+	class FNSCountingMalloc : public FMalloc
+	{
+	public:
+		/** Install에서 한 번만 채우고 그 뒤로는 바꾸지 않는다 */
+		FMalloc* Inner = nullptr;
+		bool bCounting = false;
+		int32 NumAllocs = 0;
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0) {
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim() override { Inner->Trim(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		void CountAllocation()
+		{
+			//다른 스레드는 bCounting을 읽기만 하고 세지 않는다
+			if (bCounting && IsInGameThread()) {
+				NumAllocs++;
+			}
+		}
+	};
+
+	/** 다른 스레드가 언제든 들고 있을 수 있으니 정적으로 두고 프로세스가 끝날 때까지 살려 둔다 */
+	FNSCountingMalloc CountingMalloc;
+}
+
+void FNSAllocCounter::Install()
+{
+	check(IsInGameThread());
+	if (CountingMalloc.Inner != nullptr) {
+		return;
+	}
+	CountingMalloc.Inner = GMalloc;
+	FPlatformMisc::MemoryBarrier();
+	GMalloc = &CountingMalloc;
+}
+
+bool FNSAllocCounter::IsInstalled()
+{
+	return CountingMalloc.Inner != nullptr;
+}
+
+FNSAllocCountScope::FNSAllocCountScope()
+	: StartAllocs(CountingMalloc.NumAllocs)
+	, bWasCounting(CountingMalloc.bCounting)
+{
+	check(IsInGameThread());
+	CountingMalloc.bCounting = true;
+}
+
+FNSAllocCountScope::~FNSAllocCountScope()
+{
+	CountingMalloc.bCounting = bWasCounting;
+}
+
+int32 FNSAllocCountScope::GetCount() const
+{
+	return CountingMalloc.NumAllocs - StartAllocs;
+}
+
+#endif
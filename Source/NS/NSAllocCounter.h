@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * GMalloc 앞에 끼워 두고 게임 스레드에서 FNSAllocCountScope가 열려 있는 동안의 할당을 센다.
+ * 모듈이 시작할 때 한 번 끼우고 다시 빼지 않는다. 끼운 뒤에는 원래 할당자를 가리키는 포인터가 바뀌지 않으므로
+ * 다른 스레드가 예전 GMalloc을 들고 있든 이것을 들고 있든 같은 할당자로 이어진다.
+ */
+class NS_API FNSAllocCounter
+{
+public:
+	/** 게임 모듈 시작 때 부른다. 이미 끼워져 있으면 아무것도 하지 않는다 */
+	static void Install();
+
+	static bool IsInstalled();
+};
+
+/** 범위 안에서 게임 스레드가 한 할당 수를 센다. 겹쳐 열 수 있다 */
+class NS_API FNSAllocCountScope
+{
+public:
+	FNSAllocCountScope();
+	~FNSAllocCountScope();
+
+	/** 범위를 연 뒤로 센 할당 수 */
+	int32 GetCount() const;
+
+private:
+	const int32 StartAllocs;
+	const bool bWasCounting;
+};
+
+#endif
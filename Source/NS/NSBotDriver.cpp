@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSBotDriver.h"
+#include "NSCharacter.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+#include "NSTickAudit.h"
+
+ANSBotDriver::ANSBotDriver()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	bReplicates = false;
+
+	AimDistance = 3000.0f;
+	WanderInterval = 2.0f;
+	FireInterval = 1.5f;
+	BurstDuration = 0.4f;
+	bUseAutomaticFire = true;
+
+	ForwardInput = 0.0f;
+	RightInput = 0.0f;
+	YawRate = 0.0f;
+	NextWanderTime = 0.0f;
+	NextFireTime = 0.0f;
+	StopFireTime = 0.0f;
+	bFiring = false;
+}
+
+bool ANSBotDriver::IsBotClient()
+{
+	static const bool bBotClient = FParse::Param(FCommandLine::Get(), TEXT("NSBot"));
+	return bBotClient;
+}
+
+void ANSBotDriver::Start(UWorld* World)
+{
+	if (World == nullptr) {
+		return;
+	}
+	for (TActorIterator<ANSBotDriver> Iter(World); Iter; ++Iter) {
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	World->SpawnActor<ANSBotDriver>(SpawnParams);
+}
+
+ANSCharacter* ANSBotDriver::FindTarget(ANSCharacter* Self) const
+{
+	ANSCharacter* Target = nullptr;
+	float BestDistSquared = FMath::Square(AimDistance);
+	for (TActorIterator<ANSCharacter> Iter(GetWorld()); Iter; ++Iter) {
+		ANSCharacter* Other = *Iter;
+		if (Other == Self || Other->CurrentTeam == Self->CurrentTeam || Other->IsDying()) {
+			continue;
+		}
+		const float DistSquared = FVector::DistSquared(Self->GetActorLocation(), Other->GetActorLocation());
+		if (DistSquared < BestDistSquared) {
+			BestDistSquared = DistSquared;
+			Target = Other;
+		}
+	}
+	return Target;
+}
+
+void ANSBotDriver::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
+
+	//리스폰으로 폰이 바뀔 수 있으므로 매 프레임 컨트롤러에서 다시 얻는다
+	APlayerController* thisPC = GetWorld()->GetFirstPlayerController();
+	ANSCharacter* thisChar = thisPC ? Cast<ANSCharacter>(thisPC->GetPawn()) : nullptr;
+	if (thisChar == nullptr || thisChar->IsDying()) {
+		bFiring = false;
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now >= NextWanderTime) {
+		ForwardInput = FMath::FRandRange(-0.2f, 1.0f);
+		RightInput = FMath::FRandRange(-1.0f, 1.0f);
+		YawRate = FMath::FRandRange(-90.0f, 90.0f);
+		NextWanderTime = Now + WanderInterval * FMath::FRandRange(0.5f, 1.5f);
+	}
+	thisChar->MoveForward(ForwardInput);
+	thisChar->MoveRight(RightInput);
+
+	//가까운 적이 있으면 약간 흔들어서 조준하고, 없으면 돌아다니며 둘러본다
+	ANSCharacter* Target = FindTarget(thisChar);
+	if (Target) {
+		const FVector ToTarget = Target->GetActorLocation() - thisChar->GetPawnViewLocation();
+		FRotator AimRotation = ToTarget.Rotation();
+		AimRotation.Yaw += FMath::FRandRange(-2.0f, 2.0f);
+		AimRotation.Pitch += FMath::FRandRange(-2.0f, 2.0f);
+		thisPC->SetControlRotation(AimRotation);
+	}
+	else {
+		thisPC->AddYawInput(YawRate * DeltaSeconds);
+	}
+
+	if (!bFiring && Now >= NextFireTime && Target) {
+		bFiring = true;
+		StopFireTime = Now + BurstDuration;
+		if (bUseAutomaticFire) {
+			thisChar->bAutomaticFire = true;
+		}
+		thisChar->OnFire();
+	}
+	else if (bFiring && Now >= StopFireTime) {
+		bFiring = false;
+		NextFireTime = Now + FireInterval * FMath::FRandRange(0.5f, 1.5f);
+		thisChar->OnStopFire();
+	}
+}
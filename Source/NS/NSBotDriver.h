@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NSBotDriver.generated.h"
+
+class ANSCharacter;
+
+/**
+ * 부하 테스트용 봇 입력.
+ * -NSBot으로 실행한 헤드리스 클라이언트에서 로컬 플레이어 대신 ANSCharacter를 조작한다.
+ * 실제 연결과 똑같은 RPC와 이동 패킷을 만들기 위해 AI 컨트롤러가 아니라 플레이어 컨트롤러를 그대로 쓴다.
+ * 뷰포트를 쓰지 않으므로 -nullrhi에서도 돈다.
+ */
+UCLASS(config=Game)
+class NS_API ANSBotDriver : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSBotDriver();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** 명령줄에 -NSBot이 있는지 */
+	static bool IsBotClient();
+
+	/** 월드에 드라이버가 없으면 만든다 */
+	static void Start(UWorld* World);
+
+	/** 이 거리 안의 적을 조준한다 */
+	UPROPERTY(config, EditAnywhere, Category = Bot)
+	float AimDistance;
+
+	/** 이동 방향을 바꾸는 주기(초) */
+	UPROPERTY(config, EditAnywhere, Category = Bot)
+	float WanderInterval;
+
+	/** 연사를 시작하는 주기와 한 번 쏘는 시간(초) */
+	UPROPERTY(config, EditAnywhere, Category = Bot)
+	float FireInterval;
+
+	UPROPERTY(config, EditAnywhere, Category = Bot)
+	float BurstDuration;
+
+	/** 연사 무기로 쏜다. 꺼두면 캐릭터 설정을 그대로 쓴다 */
+	UPROPERTY(config, EditAnywhere, Category = Bot)
+	bool bUseAutomaticFire;
+
+private:
+	ANSCharacter* FindTarget(ANSCharacter* Self) const;
+
+	float ForwardInput;
+	float RightInput;
+	float YawRate;
+	float NextWanderTime;
+	float NextFireTime;
+	float StopFireTime;
+	bool bFiring;
+};
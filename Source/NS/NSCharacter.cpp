@@ -6,20 +6,46 @@
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/InputSettings.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystemComponent.h"
 
 #include "Net/UnrealNetwork.h"
+#include "GameFramework/GameStateBase.h"
 #include "NSPlayerState.h"
-#include "Materials/MaterialInstanceDynamic.h"
+#include "NSEffectPool.h"
+#include "NSBotDriver.h"
+#include "NSLoadTestRecorder.h"
+#include "NSShotResolver.h"
+#include "NSRagdollBudget.h"
+#include "NSTelemetry.h"
+#include "NSCsvProfiler.h"
+#include "NSGameState.h"
 
-#include "DrawDebugHelpers.h"
 #include "Engine/Engine.h"
 #include "TimerManager.h"
+#include "NS.h"
+#include "HAL/IConsoleManager.h"
+#include "NSTickAudit.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character Relevancy"), STAT_NSCharacterRelevancy, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Shot Validate"), STAT_NSShotValidate, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Character Fire"), STAT_NSCharacterFire, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Character TakeDamage"), STAT_NSCharacterTakeDamage, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Character Respawn"), STAT_NSCharacterRespawn, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Server Fire"), STAT_NSServerFire, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Shoot Effects"), STAT_NSShootEffects, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Received"), STAT_NSShotsReceived, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events"), STAT_NSDamageEvents, STATGROUP_NS);
+
+static TAutoConsoleVariable<int32> CVarNSTeamRelevancy(
+	TEXT("ns.TeamRelevancy"),
+	1,
+	TEXT("1: teammates are always relevant regardless of cull distance. 0: default distance relevancy only (for comparison)."));
+
 //////////////////////////////////////////////////////////////////////////
 // ANSCharacter
 
@@ -28,10 +54,32 @@ ANSCharacter::ANSCharacter()
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(55.f, 96.0f);
 
+	//이동이 끝난 뒤의 히트박스를 기록하기 위해 물리 이후에 틱
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
 	// set our turn rates for input
 	BaseTurnRate = 45.f;
 	BaseLookUpRate = 45.f;
 
+	//변화가 없으면 적응형 갱신 빈도로 이 값까지 내려간다
+	MinNetUpdateFrequency = 10.0f;
+
+	bAutomaticFire = false;
+	FireRate = 600.0f;
+	ShotBatchWindow = 0.1f;
+	HitscanRange = 10000000.0f;
+	HitMarkerDuration = 0.25f;
+	FireRateTolerance = 1.5f;
+	MaxShotBurst = 5.0f;
+	MaxOriginError = 150.0f;
+	MinAimDot = 0.5f;
+	HitShapeUpdateInterval = 0.1f;
+	HeadDamageMultiplier = 2.0f;
+	LimbDamageMultiplier = 0.75f;
+	bDying = false;
+	NextHitShapeUpdateTime = 0.0f;
+
 	// Create a CameraComponent	
 	FirstPersonCameraComponent = CreateDefaultSubobject<UCameraComponent>(TEXT("FirstPersonCamera"));
 	FirstPersonCameraComponent->SetupAttachment(GetCapsuleComponent());
@@ -54,26 +102,26 @@ ANSCharacter::ANSCharacter()
 	FP_Gun->CastShadow = false;
 	FP_Gun->SetupAttachment(FP_Mesh, TEXT("GripPoint"));
 	
-	// 3Ī  ޽ Ʈ 
+	// 3인칭 건 메시 컴포넌트 생성
 	TP_Gun = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("TP_Gun"));
 	TP_Gun->SetOwnerNoSee(true);
 	TP_Gun->SetupAttachment(GetMesh(), TEXT("hand_rSocket"));
 
 	GetMesh()->SetOwnerNoSee(true);
 
-	//ƼŬ (3Ī)
+	//파티클 생성(3인칭)
 	TP_GunShotParticle = CreateDefaultSubobject<UParticleSystemComponent>(TEXT("ParticleSysTp"));
 	TP_GunShotParticle->bAutoActivate = false;
 	TP_GunShotParticle->SetupAttachment(TP_Gun);
 	TP_GunShotParticle->SetOwnerNoSee(true);
 
-	//ƼŬ (1Ī)
+	//파티클 생성(1인칭)
 	FP_GunShotParticle= CreateDefaultSubobject<UParticleSystemComponent>(TEXT("ParticleSysFp"));
 	FP_GunShotParticle->bAutoActivate = false;
 	FP_GunShotParticle->SetupAttachment(FP_Gun);
 	FP_GunShotParticle->SetOnlyOwnerSee(true);
 
-	//Ѿ ƼŬ
+	//총알 파티클
 	BulletParticle = CreateDefaultSubobject<UParticleSystemComponent>(TEXT("BulletSysTP"));
 	BulletParticle->bAutoActivate = false;
 	BulletParticle->SetupAttachment(FirstPersonCameraComponent);
@@ -95,26 +143,96 @@ void ANSCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	MeshRelativeTransform = GetMesh()->GetRelativeTransform();
+	MeshCollisionProfile = GetMesh()->GetCollisionProfileName();
+
 	if (Role != ROLE_Authority) {
 		SetTeam(CurrentTeam);
 	}
+	else {
+		ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+		if (thisGameMode) {
+			thisGameMode->GetLagCompensation().Register(this);
+		}
+	}
+
+}
+
+void ANSCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Role == ROLE_Authority) {
+		ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+		if (thisGameMode) {
+			thisGameMode->GetLagCompensation().Unregister(this);
+			thisGameMode->CancelSpawn(this);
+		}
+	}
+
+	ANSRagdollBudget* RagdollBudget = ANSRagdollBudget::Get(this);
+	if (RagdollBudget) {
+		RagdollBudget->Release(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ANSCharacter::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSCharacterRelevancy);
+
+	//팀원 위치는 멀리 있어도 알아야 하므로 거리 검사 전에 팀부터 본다
+	if (CVarNSTeamRelevancy.GetValueOnGameThread() != 0) {
+		const APlayerController* ViewerPC = Cast<APlayerController>(RealViewer);
+		const ANSPlayerState* ViewerPS = ViewerPC ? Cast<ANSPlayerState>(ViewerPC->PlayerState) : nullptr;
+		if (ViewerPS && ViewerPS->GetTeam() == CurrentTeam) {
+			return true;
+		}
+	}
+
+	return Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation);
+}
+
+void ANSCharacter::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
 
+	if (Role == ROLE_Authority) {
+		//랙 보상을 위해 이번 프레임의 히트박스를 기록한다
+		const UCapsuleComponent* Capsule = GetCapsuleComponent();
+
+		FNSPoseSnapshot Snapshot;
+		Snapshot.Time = GetWorld()->GetTimeSeconds();
+		Snapshot.Location = Capsule->GetComponentLocation();
+		Snapshot.Rotation = Capsule->GetComponentQuat();
+		Snapshot.Radius = Capsule->GetScaledCapsuleRadius();
+		Snapshot.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+		Snapshot.EyeLocation = FirstPersonCameraComponent->GetComponentLocation();
+		PoseHistory.Record(Snapshot);
+
+		//부위 캡슐은 루트 기준이라 자주 바뀌지 않는다. 죽어 있는 동안은 맞을 일이 없으니 갱신하지 않는다
+		if (Snapshot.Time >= NextHitShapeUpdateTime && !bDying) {
+			HitShapes.Update(GetMesh(), FTransform(Snapshot.Rotation, Snapshot.Location));
+			NextHitShapeUpdateTime = Snapshot.Time + HitShapeUpdateInterval;
+		}
+	}
 }
 
 void ANSCharacter::SetTeam_Implementation(ETeam NewTeam) {
-	FLinearColor outColour;
-	if (NewTeam == ETeam::BLUE_TEAM) {
-		outColour = FLinearColor(0.0f, 0.0f, 0.5f);
+	//그리지 않는 전용 서버에서는 색을 입힐 필요가 없다
+	if (GetNetMode() == NM_DedicatedServer) {
+		return;
 	}
 
-	else {
-		outColour = FLinearColor(0.5f, 0.0f, 0.0f);
+	//팀 머티리얼은 게임 상태가 월드당 팀마다 하나씩만 만든다
+	if (BodyMaterial == nullptr) {
+		BodyMaterial = GetMesh()->GetMaterial(0);
 	}
-	if (DynamicMat == nullptr) {
-		DynamicMat = UMaterialInstanceDynamic::Create(GetMesh()->GetMaterial(0), this);
-		DynamicMat->SetVectorParameterValue(TEXT("BodyColor"), outColour);
-		GetMesh()->SetMaterial(0, DynamicMat);
-		FP_Mesh->SetMaterial(0, DynamicMat);
+	ANSGameState* thisGameState = GetWorld()->GetGameState<ANSGameState>();
+	UMaterialInterface* TeamMaterial = thisGameState ? thisGameState->GetTeamMaterial(NewTeam, BodyMaterial) : nullptr;
+	if (TeamMaterial != nullptr && GetMesh()->GetMaterial(0) != TeamMaterial) {
+		GetMesh()->SetMaterial(0, TeamMaterial);
+		FP_Mesh->SetMaterial(0, TeamMaterial);
 	}
 }
 
@@ -132,6 +250,10 @@ void ANSCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputC
 
 	// Bind fire event
 	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ANSCharacter::OnFire);
+	PlayerInputComponent->BindAction("Fire", IE_Released, this, &ANSCharacter::OnStopFire);
+
+	// Bind lobby start event
+	PlayerInputComponent->BindAction("StartMatch", IE_Pressed, this, &ANSCharacter::OnStartMatch);
 
 
 	// Bind movement events
@@ -154,23 +276,33 @@ void ANSCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLife
 
 float ANSCharacter::TakeDamage(float Damage, FDamageEvent const & DamageEvent, AController * EventInstigator, AActor * DamageCauser)
 {
+	SCOPE_CYCLE_COUNTER(STAT_NSCharacterTakeDamage);
+	NS_CSV_SCOPE(Damage);
+	INC_DWORD_STAT(STAT_NSDamageEvents);
 	Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
 
-	if (Role == ROLE_Authority && DamageCauser != this && NSPlayerState->Health > 0) {
-		NSPlayerState->Health -= Damage;
+	if (Role == ROLE_Authority && DamageCauser != this && NSPlayerState->GetHealth() > 0) {
+		NSPlayerState->SetHealth(NSPlayerState->GetHealth() - Damage);
 		PlayPain();
-
-		if (NSPlayerState->Health <= 0) {
-			NSPlayerState->Deaths++;
-			//÷̾  ð  ״´
+		const int32 CauserId = FNSTelemetry::GetPlayerId(Cast<APawn>(DamageCauser));
+		FNSTelemetry::Record(ENSTelemetryEvent::Hit, FNSTelemetry::GetPlayerId(this), CauserId, GetActorLocation(), Damage);
+
+		if (NSPlayerState->GetHealth() <= 0) {
+			NSPlayerState->AddDeath();
+			FNSTelemetry::Record(ENSTelemetryEvent::Kill, FNSTelemetry::GetPlayerId(this), CauserId, GetActorLocation());
+			ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+			if (thisGameMode) {
+				thisGameMode->RecordDeath(GetActorLocation());
+			}
+			//플레이어가 리스폰할 시간 동안 죽는다
 			MultiCastRagdoll();
 			ANSCharacter* OtherChar = Cast<ANSCharacter>(DamageCauser);
 
 			if (OtherChar) {
-				OtherChar->NSPlayerState->Score += 1.0f;
+				OtherChar->NSPlayerState->AddScore(1.0f);
 			}
 
-			//3ʵ 
+			//3초뒤 리스폰
 			FTimerHandle thisTimer;
 
 			GetWorldTimerManager().SetTimer<ANSCharacter>(thisTimer, this, &ANSCharacter::Respawn, 3.0f, false);
@@ -186,13 +318,23 @@ void ANSCharacter::PossessedBy(AController * NewController)
 
 	NSPlayerState = Cast<ANSPlayerState>(PlayerState);
 	if (Role == ROLE_Authority && NSPlayerState != nullptr) {
-		NSPlayerState->Health = 100.0f;
+		NSPlayerState->SetHealth(100.0f);
+	}
+}
+
+void ANSCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	//-NSBot으로 실행한 클라이언트는 봇이 입력을 대신한다
+	if (ANSBotDriver::IsBotClient()) {
+		ANSBotDriver::Start(GetWorld());
 	}
 }
 
-bool ANSCharacter::ServerFire_Validate(const FVector pos, const FVector dir)
+bool ANSCharacter::ServerFire_Validate(const FVector_NetQuantize pos, const FVector_NetQuantizeNormal dir, float ClientTime, uint16 ShotId)
 {
-	if (pos != FVector(ForceInit) && dir != FVector(ForceInit)) {
+	if (pos != FVector(ForceInit) && dir != FVector(ForceInit) && !pos.ContainsNaN() && !dir.ContainsNaN() && FMath::IsFinite(ClientTime)) {
 		return true;
 	}
 	else {
@@ -200,9 +342,85 @@ bool ANSCharacter::ServerFire_Validate(const FVector pos, const FVector dir)
 	}
 }
 
-void ANSCharacter::ServerFire_Implementation(const FVector pos, const FVector dir) {
-	Fire(pos, dir);
-	MultiCastShootEffects();
+void ANSCharacter::ServerFire_Implementation(const FVector_NetQuantize pos, const FVector_NetQuantizeNormal dir, float ClientTime, uint16 ShotId) {
+	SCOPE_CYCLE_COUNTER(STAT_NSServerFire);
+	NS_CSV_SCOPE(Shooting);
+	INC_DWORD_STAT(STAT_NSShotsReceived);
+	ANSLoadTestRecorder::CountRPC();
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	ANSShotResolver* Resolver = thisGameMode ? thisGameMode->GetShotResolver() : nullptr;
+	if (Resolver == nullptr) {
+		//판정할 곳이 없으면 클라이언트 예측이 풀리도록 바로 실패로 ack한다
+		ClientAckShots(ShotId, 1, 0);
+		return;
+	}
+	//판정과 ack는 다음 프레임에 판정 큐가 한다. 버린 발사는 트레이스도 이펙트도 없이 실패로 ack된다
+	const bool bValid = ValidateShot(pos, dir, ClientTime, ShotId);
+	Resolver->QueueShot(this, pos, dir, ClientTime, ShotId, bValid);
+	if (bValid) {
+		MultiCastShootEffects();
+	}
+}
+
+bool ANSCharacter::ServerFireBatch_Validate(const FNSShotBatch& Batch)
+{
+	return Batch.Shots.Num() > 0 && Batch.Shots.Num() <= FNSShotBatch::MaxShots;
+}
+
+void ANSCharacter::ServerFireBatch_Implementation(const FNSShotBatch& Batch)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSServerFire);
+	NS_CSV_SCOPE(Shooting);
+	INC_DWORD_STAT_BY(STAT_NSShotsReceived, Batch.Shots.Num());
+	ANSLoadTestRecorder::CountRPC();
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	ANSShotResolver* Resolver = thisGameMode ? thisGameMode->GetShotResolver() : nullptr;
+	if (Resolver == nullptr) {
+		//배치의 ShotId는 연속이라 ack 하나로 모두 실패 처리한다
+		ClientAckShots(Batch.GetShotId(0), (uint8)Batch.Shots.Num(), 0);
+		return;
+	}
+	//배치 안의 발사는 연속된 시퀀스라 판정 큐가 ack 하나로 다시 묶는다
+	for (int32 i = 0; i < Batch.Shots.Num(); i++) {
+		const FVector Origin = Batch.Shots[i].Origin;
+		const FVector Direction = Batch.GetDirection(i);
+		const float ShotTime = Batch.GetShotTime(i);
+		const uint16 ShotId = Batch.GetShotId(i);
+		const bool bValid = ValidateShot(Origin, Direction, ShotTime, ShotId);
+		Resolver->QueueShot(this, Origin, Direction, ShotTime, ShotId, bValid);
+		if (bValid) {
+			MultiCastShootEffects();
+		}
+	}
+}
+
+bool ANSCharacter::ServerRequestStartMatch_Validate()
+{
+	return true;
+}
+
+void ANSCharacter::ServerRequestStartMatch_Implementation()
+{
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	if (thisGameMode) {
+		thisGameMode->RequestStartMatch(Cast<APlayerController>(GetController()));
+	}
+}
+
+void ANSCharacter::ClientAckShots_Implementation(uint16 FirstShotId, uint8 Count, uint16 ConfirmMask)
+{
+	//예측 못한 히트는 지금이라도 피드백을 준다
+	if (ShotPrediction.Reconcile(FirstShotId, Count, ConfirmMask, GetWorld()->GetTimeSeconds()) > 0) {
+		APlayerController* thisPC = Cast<APlayerController>(GetController());
+		if (thisPC) {
+			thisPC->ClientPlayForceFeedback(HitSuccessFeedback, false, true, NAME_None);
+		}
+	}
+}
+
+bool ANSCharacter::HasActiveHitMarker() const
+{
+	return ShotPrediction.HasActiveHitMarker(GetWorld()->GetTimeSeconds(), HitMarkerDuration);
 }
 
 ANSPlayerState * ANSCharacter::GetNSPlayerState()
@@ -219,7 +437,7 @@ ANSPlayerState * ANSCharacter::GetNSPlayerState()
 
 void ANSCharacter::SetNSPlayerState(ANSPlayerState * newPS)
 {
-	//PS ȿϰ  ƴ ȮѴ
+	//PS가 유효하고 서버에만 설정됐는지 확인한다
 	if (newPS && Role == ROLE_Authority) {
 		NSPlayerState = newPS;
 		PlayerState = newPS;
@@ -227,18 +445,74 @@ void ANSCharacter::SetNSPlayerState(ANSPlayerState * newPS)
 }
 
 void ANSCharacter::Respawn()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSCharacterRespawn);
+	NS_CSV_SCOPE(Spawning);
+	if (Role == ROLE_Authority) {
+		//체력은 스폰 지점에 놓인 뒤 FinishRespawn에서 채운다. 폰을 재사용하지 않았을 때만 지운다
+		if (!Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode())->Respawn(this)) {
+			Destroy(true, true);
+		}
+	}
+}
+
+float ANSCharacter::GetDamageMultiplier(ENSHitZone Zone) const
+{
+	switch (Zone) {
+	case ENSHitZone::Head:
+		return HeadDamageMultiplier;
+	case ENSHitZone::Limb:
+		return LimbDamageMultiplier;
+	default:
+		return 1.0f;
+	}
+}
+
+void ANSCharacter::BeginRespawnWait()
 {
 	if (Role == ROLE_Authority) {
-		// κ ġ 
-		NSPlayerState->Health = 100.0f;
-		Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode())->Respawn(this);
+		MultiCastBeginRespawnWait();
+	}
+}
 
-		Destroy(true, true);
+void ANSCharacter::FinishRespawn()
+{
+	if (Role == ROLE_Authority) {
+		//텔레포트 전후 위치를 보간하지 않도록 기록을 비운다
+		PoseHistory.Reset();
+		NextHitShapeUpdateTime = 0.0f;
+		//스트레스 테스트 폰은 플레이어 상태가 없다
+		if (GetNSPlayerState()) {
+			GetNSPlayerState()->SetHealth(100.0f);
+		}
+		MultiCastFinishRespawn();
 	}
 }
 
+void ANSCharacter::OnStartMatch()
+{
+	ServerRequestStartMatch();
+}
+
 void ANSCharacter::OnFire()
 {
+	FireShot();
+
+	if (bAutomaticFire) {
+		GetWorldTimerManager().SetTimer(AutoFireTimer, this, &ANSCharacter::FireShot, 60.0f / FireRate, true);
+	}
+}
+
+void ANSCharacter::OnStopFire()
+{
+	GetWorldTimerManager().ClearTimer(AutoFireTimer);
+	FlushShotBatch();
+}
+
+void ANSCharacter::FireShot()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSCharacterFire);
+	NS_CSV_SCOPE(Shooting);
 
 	// try and play a firing animation if specified
 	if (FP_FireAnimation != NULL)
@@ -251,22 +525,97 @@ void ANSCharacter::OnFire()
 		}
 	}
 
-	//ƴٸ FP ƼŬ Ʈ Ѵ
+	//지정됐다면 FP 파티클 이펙트를 재생한다
 	if (FP_GunShotParticle != nullptr) {
 		FP_GunShotParticle->Activate(true);
 	}
 
+	//멀티캐스트를 기다리지 않고 소리와 총알 이펙트를 바로 재생한다
+	ANSEffectPool* EffectPool = ANSEffectPool::Get(this);
+	if (EffectPool) {
+		EffectPool->PlaySound(FireSound, GetActorLocation());
+		if (BulletParticle != nullptr) {
+			EffectPool->SpawnParticle(BulletParticle->Template, BulletParticle->GetComponentLocation(), BulletParticle->GetComponentRotation());
+		}
+	}
+
 	FVector mousePos;
 	FVector mouseDir;
 
 	APlayerController* pController = Cast<APlayerController>(GetController());
-	FVector2D ScreenPos = GEngine->GameViewport->Viewport->GetSizeXY();
+	if (pController == nullptr) {
+		return;
+	}
+
+	//화면 중앙 = 카메라 정면. 뷰포트가 없는 헤드리스 클라이언트에서도 같은 결과가 나온다
+	FRotator ViewRotation;
+	pController->GetPlayerViewPoint(mousePos, ViewRotation);
+	mouseDir = ViewRotation.Vector();
+
+	//서버가 히트박스를 되감을 수 있도록 서버 기준 발사 시각을 같이 보낸다
+	AGameStateBase* thisGameState = GetWorld()->GetGameState();
+	const float ShotTime = thisGameState ? thisGameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+	const uint16 ShotId = ShotPrediction.NextShotId();
+
+	//서버 판정을 기다리지 않고 히트 마커와 피격 이펙트를 먼저 보여준다
+	FVector HitLocation;
+	if (PredictHit(mousePos, mouseDir, HitLocation)) {
+		ShotPrediction.AddPredictedHit(ShotId, HitLocation, GetWorld()->GetTimeSeconds());
+		if (EffectPool) {
+			EffectPool->SpawnParticle(ImpactParticle, HitLocation, (-mouseDir).Rotation());
+		}
+		pController->ClientPlayForceFeedback(HitSuccessFeedback, false, true, NAME_None);
+	}
+
+	if (bAutomaticFire) {
+		//배치가 꽉 찼으면 먼저 보내고 새 배치를 시작한다
+		if (!PendingShots.AddShot(ShotId, mousePos, mouseDir, ShotTime)) {
+			FlushShotBatch();
+			PendingShots.AddShot(ShotId, mousePos, mouseDir, ShotTime);
+		}
+		if (ShotTime - PendingShots.BaseTime >= ShotBatchWindow) {
+			FlushShotBatch();
+		}
+	}
+	else {
+		ServerFire(mousePos, mouseDir, ShotTime, ShotId);
+	}
+}//FireShot 닫기
+
+void ANSCharacter::FlushShotBatch()
+{
+	if (PendingShots.Shots.Num() > 0) {
+		ServerFireBatch(PendingShots);
+		PendingShots.Reset();
+	}
+}
+
+bool ANSCharacter::PredictHit(const FVector& pos, const FVector& dir, FVector& OutLocation)
+{
+	//클라이언트에 보이는 캡슐은 이미 과거 위치이므로 되감기 없이 그대로 검사한다
+	FCollisionObjectQueryParams ObjQuery(ECC_Pawn);
+
+	FCollisionQueryParams ColQuery;
+	ColQuery.AddIgnoredActor(this);
+
+	FHitResult HitRes;
+	if (!GetWorld()->LineTraceSingleByObjectType(HitRes, pos, pos + dir * HitscanRange, ObjQuery, ColQuery)) {
+		return false;
+	}
 
-	pController->DeprojectScreenPositionToWorld(ScreenPos.X / 2.0f, ScreenPos.Y / 2.0f, mousePos, mouseDir);
-	mouseDir *= 10000000.0f;
+	ANSCharacter* OtherChar = Cast<ANSCharacter>(HitRes.GetActor());
+	if (OtherChar == nullptr || OtherChar->CurrentTeam == CurrentTeam || OtherChar->IsDying()) {
+		return false;
+	}
+
+	ColQuery.AddIgnoredActor(OtherChar);
+	if (GetWorld()->LineTraceTestByChannel(pos, HitRes.ImpactPoint, ECC_Visibility, ColQuery)) {
+		return false;
+	}
 
-	ServerFire(mousePos, mouseDir);
-}//Onfire ݱ
+	OutLocation = HitRes.ImpactPoint;
+	return true;
+}
 
 
 //Commenting this section out to be consistent with FPS BP template.
@@ -337,37 +686,65 @@ void ANSCharacter::LookUpAtRate(float Rate)
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
 }
 
-void ANSCharacter::Fire(const FVector pos, const FVector dir)
+bool ANSCharacter::ValidateShot(const FVector& pos, const FVector& dir, float ShotTime, uint16 ShotId)
 {
-	//ĳƮ 
-	FCollisionObjectQueryParams ObjQuery;
-	ObjQuery.AddObjectTypesToQuery(ECC_GameTraceChannel1);
-
-	FCollisionQueryParams ColQuery;
-	ColQuery.AddIgnoredActor(this);
+	SCOPE_CYCLE_COUNTER(STAT_NSShotValidate);
 
-	FHitResult HitRes;
-	GetWorld()->LineTraceSingleByObjectType(HitRes, pos, dir, ObjQuery, ColQuery);
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	ANSPlayerState* thisPS = GetNSPlayerState();
+	if (thisGameMode == nullptr || thisPS == nullptr) {
+		return false;
+	}
 
-	DrawDebugLine(GetWorld(), pos, dir, FColor::Red, true, 100, 0, 5.0f);
+	FNSShotValidator& Validator = thisPS->GetShotValidator();
+	const float Now = GetWorld()->GetTimeSeconds();
+	ENSShotViolation Violation = ENSShotViolation::None;
+	float Value = 0.0f;
 
-	if (HitRes.bBlockingHit) {
-		ANSCharacter* OtherChar = Cast<ANSCharacter>(HitRes.GetActor());
-		if (OtherChar != nullptr&&OtherChar->GetNSPlayerState()->Team != this->GetNSPlayerState()->Team) {
-			FDamageEvent thisEvent(UDamageType::StaticClass());
-			OtherChar->TakeDamage(10.0f, thisEvent, this->GetController(), this);
-			APlayerController* thisPC = Cast<APlayerController>(GetController());
-			thisPC->ClientPlayForceFeedback(HitSuccessFeedback, false,true ,NAME_None);
+	//싼 검사부터 한다. 원점 검사만 포즈 기록을 찾는다
+	if (!Validator.ConsumeToken(Now, FireRate / 60.0f * FireRateTolerance, MaxShotBurst)) {
+		Violation = ENSShotViolation::RateLimited;
+	}
+	else if (!FNSShotValidator::IsValidDirection(dir, GetBaseAimRotation().Vector(), MinAimDot)) {
+		Violation = ENSShotViolation::BadDirection;
+		Value = FVector::DotProduct(dir.GetSafeNormal(), GetBaseAimRotation().Vector());
+	}
+	else if (ShotTime > Now + thisGameMode->GetLagCompensation().MaxRewindTime) {
+		Violation = ENSShotViolation::BadTime;
+		Value = ShotTime - Now;
+	}
+	else {
+		FNSPoseSnapshot Pose;
+		const float RewindTime = thisGameMode->GetLagCompensation().ClampRewindTime(ShotTime, Now);
+		if (PoseHistory.Sample(RewindTime, Pose)) {
+			const float OriginError = FVector::Dist(pos, Pose.EyeLocation);
+			if (OriginError > MaxOriginError) {
+				Violation = ENSShotViolation::BadOrigin;
+				Value = OriginError;
+			}
 		}
 	}
+
+	if (Violation != ENSShotViolation::None) {
+		Validator.LogViolation(Now, ShotId, Violation, Value);
+		return false;
+	}
+	return true;
 }
 
 void ANSCharacter::MultiCastShootEffects_Implementation() {
+	SCOPE_CYCLE_COUNTER(STAT_NSShootEffects);
+	NS_CSV_SCOPE(Effects);
+
+	//쏜 사람은 발사할 때 이미 재생했다
+	if (IsLocallyControlled()) {
+		return;
+	}
 
-	//ƴٸ ߻ ִϸ̼ Ѵ
+	//지정됐다면 발사 애니메이션을 재생한다
 	if (TP_FireAnimation != NULL) {
 
-		// ޽ ִϸ̼ Ʈ ´
+		//팔 메시의 애니메이션 오브젝트를 얻는다
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 		if (AnimInstance != NULL)
 		{
@@ -375,18 +752,18 @@ void ANSCharacter::MultiCastShootEffects_Implementation() {
 		}
 	}
 
-	//    õѴ
-	if (FireSound != NULL) {
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
-	}
 	if (TP_GunShotParticle != nullptr)
 	{
 		TP_GunShotParticle->Activate(true);
 	}
 
-	if (BulletParticle != nullptr)
-	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), BulletParticle->Template, BulletParticle->GetComponentLocation(), BulletParticle->GetComponentRotation());
+	//사운드와 총알 이펙트는 풀에서 꺼내 재생한다. 데디케이티드 서버에서는 풀이 없다
+	ANSEffectPool* EffectPool = ANSEffectPool::Get(this);
+	if (EffectPool) {
+		EffectPool->PlaySound(FireSound, GetActorLocation());
+		if (BulletParticle != nullptr) {
+			EffectPool->SpawnParticle(BulletParticle->Template, BulletParticle->GetComponentLocation(), BulletParticle->GetComponentRotation());
+		}
 	}
 
 }
@@ -398,7 +775,79 @@ void ANSCharacter::PlayPain_Implementation() {
 }
 
 void ANSCharacter::MultiCastRagdoll_Implementation() {
-	GetMesh()->SetPhysicsBlendWeight(1.0f);
-	GetMesh()->SetSimulatePhysics(true);
-	GetMesh()->SetCollisionProfileName("Ragdoll");
+	bDying = true;
+
+	//죽어 있는 동안은 움직이거나 쏠 수 없다
+	GetCharacterMovement()->DisableMovement();
+	GetWorldTimerManager().ClearTimer(AutoFireTimer);
+	PendingShots.Reset();
+	APlayerController* thisPC = Cast<APlayerController>(GetController());
+	if (thisPC && IsLocallyControlled()) {
+		DisableInput(thisPC);
+	}
+
+	//사망 물리는 보여주기 위한 것이다. 서버는 캡슐만 남기고 메시는 건드리지 않는다
+	ANSRagdollBudget* RagdollBudget = ANSRagdollBudget::Get(this);
+	if (RagdollBudget == nullptr) {
+		return;
+	}
+	if (RagdollBudget->RequestRagdoll(this)) {
+		GetMesh()->SetPhysicsBlendWeight(1.0f);
+		GetMesh()->SetSimulatePhysics(true);
+		GetMesh()->SetCollisionProfileName("Ragdoll");
+	}
+	else {
+		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+		if (TP_DeathAnimation == nullptr || AnimInstance == nullptr || AnimInstance->Montage_Play(TP_DeathAnimation, 1.f) <= 0.0f) {
+			//몽타주가 없으면 선 채로 남지 않도록 애니메이션을 멈추고 메시를 옆으로 눕힌다. 리스폰 때 되돌린다
+			const FQuat LieRotation(FVector::ForwardVector, HALF_PI);
+			GetMesh()->bPauseAnims = true;
+			GetMesh()->SetRelativeLocationAndRotation(MeshRelativeTransform.GetLocation() + FVector(0.0f, 0.0f, GetCapsuleComponent()->GetScaledCapsuleRadius() * 0.5f),
+				LieRotation * MeshRelativeTransform.GetRotation());
+		}
+	}
+}
+
+void ANSCharacter::MultiCastBeginRespawnWait_Implementation() {
+	//스폰 지점에 놓일 때까지 죽은 것으로 보고 판정과 봇 조준에서 뺀다
+	bDying = true;
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	GetCharacterMovement()->DisableMovement();
+	GetWorldTimerManager().ClearTimer(AutoFireTimer);
+	PendingShots.Reset();
+	APlayerController* thisPC = Cast<APlayerController>(GetController());
+	if (thisPC && IsLocallyControlled()) {
+		DisableInput(thisPC);
+	}
+
+	ANSRagdollBudget* RagdollBudget = ANSRagdollBudget::Get(this);
+	if (RagdollBudget) {
+		RagdollBudget->Release(this);
+	}
+	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	if (AnimInstance != nullptr && TP_DeathAnimation != nullptr) {
+		AnimInstance->Montage_Stop(0.0f, TP_DeathAnimation);
+	}
+
+	//물리를 끄고 캡슐에 다시 붙여 애니메이션 포즈로 되돌린다. 고정된 래그돌은 틱도, 눕힌 메시는 애니메이션도 다시 켠다
+	GetMesh()->SetComponentTickEnabled(true);
+	GetMesh()->bPauseAnims = false;
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->SetCollisionProfileName(MeshCollisionProfile);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshRelativeTransform);
+}
+
+void ANSCharacter::MultiCastFinishRespawn_Implementation() {
+	bDying = false;
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	APlayerController* thisPC = Cast<APlayerController>(GetController());
+	if (thisPC && IsLocallyControlled()) {
+		EnableInput(thisPC);
+	}
 }
\ No newline at end of file
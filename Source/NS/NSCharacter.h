@@ -6,6 +6,9 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/ForceFeedbackEffect.h"
 #include "NSSGameMode.h"
+#include "NSLagCompensation.h"
+#include "NSShotBatch.h"
+#include "NSShotPrediction.h"
 #include "NSCharacter.generated.h"
 
 class UInputComponent;
@@ -23,7 +26,7 @@ class ANSCharacter : public ACharacter
 	UPROPERTY(VisibleDefaultsOnly, Category = Mesh)
 	class USkeletalMeshComponent* FP_Gun;
 
-	/**  ޽: 3Ī (ٸ Ը ) */
+	/** 건 메시: 3인칭 뷰(다른 사람에게만 보임) */
 	UPROPERTY(VisibleDefaultsOnly, Category = Mesh)
 	class USkeletalMeshComponent* TP_Gun;
 
@@ -41,6 +44,17 @@ public:
 
 protected:
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	virtual void Tick(float DeltaSeconds) override;
+
+	/**
+	 * 같은 팀 연결에는 거리와 상관없이 항상 보낸다. 적은 엔진 기본 거리 검사를 쓴다.
+	 * 4.19 넷 드라이버는 고려 대상 액터마다 연결별로 이 함수를 부르므로 공간 그리드를 둬도 호출 수는 줄지 않고,
+	 * 기본 거리 검사는 이미 제곱 거리 비교 한 번이라 그리드로 얻을 것이 없다. 그래서 그리드와 리플리케이션 그래프는 두지 않는다
+	 */
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
 
 public:
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
@@ -55,11 +69,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	class USoundBase* FireSound;
 
-	/**   ÷   */
+	/** 맞을 때마다 플레이 할 사운드 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class USoundBase* PainSound;
 
-	/**  ߻縦  3Ī ִϸ̼ Ÿ */
+	/** 총 발사를 위한 3인칭 애니메이션 몽타주 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UAnimMontage* TP_FireAnimation;
 
@@ -67,22 +81,77 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UAnimMontage* FP_FireAnimation;
 
-	/**  ߻ȿ  3Ī ƼŬ ý */
+	/** 래그돌 예산을 넘었거나 멀리서 죽었을 때 대신 재생할 3인칭 사망 몽타주. 비어 있으면 메시를 눕히기만 한다 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	class UAnimMontage* TP_DeathAnimation;
+
+	/** 총 발사효과를 위한 3인칭 파티클 시스템 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UParticleSystemComponent* TP_GunShotParticle;
 
-	/**  ߻ȿ  1Ī ƼŬ ý */
+	/** 총 발사효과를 위한 1인칭 파티클 시스템 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UParticleSystemComponent* FP_GunShotParticle;
 
-	/** Ѿ ǥ ƼŬ ý */
+	/** 총알을 표현할 파티클 시스템 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UParticleSystemComponent* BulletParticle;
 
-	/**  ǵ */
+	/** 포스 피드백 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UForceFeedbackEffect* HitSuccessFeedback;
 
+	/** 버튼을 누르고 있는 동안 연사할지 여부 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	bool bAutomaticFire;
+
+	/** 연사 속도(분당 발사 수) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (ClampMin = "1.0"))
+	float FireRate;
+
+	/** 연사 중 발사를 모아서 보내는 최대 시간(초) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (ClampMin = "0.0", ClampMax = "0.25"))
+	float ShotBatchWindow;
+
+	/** 히트스캔 사거리 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	float HitscanRange;
+
+	/** 예측 히트 지점에 재생할 파티클 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	class UParticleSystem* ImpactParticle;
+
+	/** 히트 마커를 보여줄 시간(초) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	float HitMarkerDuration;
+
+	/** 서버가 허용하는 발사 속도 = FireRate x 이 값 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Validation)
+	float FireRateTolerance;
+
+	/** 속도 제한 전에 연달아 허용하는 발사 수 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Validation)
+	float MaxShotBurst;
+
+	/** 발사 원점과 되감은 카메라 위치의 최대 거리 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Validation)
+	float MaxOriginError;
+
+	/** 발사 방향과 서버가 아는 조준 방향의 최소 내적(0.5 = 60도) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Validation)
+	float MinAimDot;
+
+	/** 애니메이션 포즈로 히트 캡슐을 다시 만드는 주기(초) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HitShapes, meta = (ClampMin = "0.0"))
+	float HitShapeUpdateInterval;
+
+	/** 머리와 팔다리에 맞았을 때의 피해 배율 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HitShapes)
+	float HeadDamageMultiplier;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = HitShapes)
+	float LimbDamageMultiplier;
+
 	UPROPERTY(Replicated, BlueprintReadWrite, Category = Team)
 		ETeam CurrentTeam;
 
@@ -90,11 +159,47 @@ public:
 	void SetNSPlayerState(class ANSPlayerState* newPS);
 	void Respawn();
 
+	/**
+	 * 스폰 지점을 기다리는 동안 폰을 숨기고 충돌과 판정에서 뺀다(서버에서 호출).
+	 * 래그돌은 여기서 풀고, 체력과 조작은 FinishRespawn에서 되돌린다
+	 */
+	void BeginRespawnWait();
+
+	/** 스폰 지점으로 옮겨진 뒤 체력을 채우고 다시 보이게 한다(서버에서 호출) */
+	void FinishRespawn();
+
+	const FNSPoseHistory& GetPoseHistory() const { return PoseHistory; }
+	const FNSHitShapeSet& GetHitShapes() const { return HitShapes; }
+
+	/** 죽었거나 스폰 지점을 기다리는 중인지. 래그돌 여부와 상관없이 모든 머신에서 같다 */
+	bool IsDying() const { return bDying; }
+
+	/** 부위별 피해 배율 */
+	float GetDamageMultiplier(ENSHitZone Zone) const;
+
+	/** 서버가 되돌리지 않은 예측 히트가 최근에 있었는지 */
+	bool HasActiveHitMarker() const;
+
 protected:
 	
 	/** Fires a projectile. */
 	void OnFire();
 
+	/** 연사 중단 */
+	void OnStopFire();
+
+	/** StartMatch 액션. 로비에서 호스트가 누르면 매치를 시작한다 */
+	void OnStartMatch();
+
+	/** 한 발을 쏜다. 연사 중이면 배치에 모으고 아니면 바로 서버로 보낸다 */
+	void FireShot();
+
+	/** 모아둔 발사를 서버로 보낸다 */
+	void FlushShotBatch();
+
+	/** 클라이언트에서 같은 트레이스를 먼저 수행해 히트를 예측한다 */
+	bool PredictHit(const FVector& pos, const FVector& dir, FVector& OutLocation);
+
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
 
@@ -113,19 +218,50 @@ protected:
 	 */
 	void LookUpAtRate(float Rate);
 
-	//Ʈ̽  ϱ  ȣ
-	void Fire(const FVector pos, const FVector dir);
+	//트레이스 전에 발사 속도, 방향, 시각, 원점을 검사한다. 버린 발사는 위반 기록에 남긴다
+	bool ValidateShot(const FVector& pos, const FVector& dir, float ShotTime, uint16 ShotId);
 
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 	virtual void PossessedBy(AController* NewController) override;
+	virtual void PawnClientRestart() override;
 	// End of APawn interface
 
-	class UMaterialInstanceDynamic* DynamicMat;
+	//부하 테스트 봇이 입력 함수를 직접 호출한다
+	friend class ANSBotDriver;
+
+	//판정 큐가 처리한 발사를 ack한다
+	friend class ANSShotResolver;
+
+	/** 팀 머티리얼을 입히기 전 메시의 머티리얼. 팀 머티리얼의 부모가 된다 */
+	UPROPERTY(Transient)
+	class UMaterialInterface* BodyMaterial;
+
 	class ANSPlayerState* NSPlayerState;
 
+	/** 래그돌에서 되돌릴 때 쓰는 메시의 원래 상태 */
+	FTransform MeshRelativeTransform;
+	FName MeshCollisionProfile;
+
+	/** 서버로 보내기 전에 모아둔 연사 발사 */
+	FNSShotBatch PendingShots;
+
+	FTimerHandle AutoFireTimer;
+
+	/** 소유 클라이언트의 발사 시퀀스와 예측 히트 */
+	FNSShotPrediction ShotPrediction;
+
+	/** 랙 보상을 위한 히트박스 기록(서버 전용) */
+	FNSPoseHistory PoseHistory;
+
+	/** 부위별 히트 캡슐(서버 전용, 액터 로컬 공간) */
+	FNSHitShapeSet HitShapes;
+	float NextHitShapeUpdateTime;
+
+	bool bDying;
+
 
 
 public:
@@ -137,27 +273,47 @@ public:
 
 
 
-/**  ν ȣ */
+/** 원격 프로시저 호출 */
 private:
-	// fire ׼ 
+	//서버에서 fire 액션 수행
+	UFUNCTION(Server, Reliable, WithValidation)
+		void ServerFire(const FVector_NetQuantize pos, const FVector_NetQuantizeNormal dir, float ClientTime, uint16 ShotId);
+
+	//연사 시 여러 발을 한 번에 서버로 보낸다
+	UFUNCTION(Server, Reliable, WithValidation)
+		void ServerFireBatch(const FNSShotBatch& Batch);
+
+	//로비에서 매치 시작을 요청한다. 게임 모드가 호스트인지 확인한다
 	UFUNCTION(Server, Reliable, WithValidation)
-		void ServerFire(const FVector pos, const FVector dir);
+		void ServerRequestStartMatch();
+
+	//FirstShotId부터 Count발의 판정 결과를 소유 클라이언트에게 알린다. ConfirmMask의 비트가 히트
+	UFUNCTION(Client, Reliable)
+		void ClientAckShots(uint16 FirstShotId, uint8 Count, uint16 ConfirmMask);
 
-	// Ŭ̾Ʈ ߻ ȿ ϴ ƼĳƮ
+	//모든 클라이언트가 발사 효과를 실행하는 멀티캐스트
 	UFUNCTION(NetMultiCast, unreliable)
 		void MultiCastShootEffects();
 
-	//   Ŭ̾Ʈ  ϱ  ȣȴ
+	//사망 시 모든 클라이언트에게 사망을 전달하기 위해 호출된다
 	UFUNCTION(NetMultiCast, unreliable)
 		void MultiCastRagdoll();
 
-	//Ʈ   Ŭ̾Ʈ  ش
+	//리스폰 대기를 시작할 때 모든 클라이언트에서 래그돌을 애니메이션 상태로 되돌리고 폰을 숨긴다
+	UFUNCTION(NetMultiCast, Reliable)
+		void MultiCastBeginRespawnWait();
+
+	//스폰 지점에 놓인 뒤 모든 클라이언트에서 폰을 다시 보이게 하고 조작을 돌려준다
+	UFUNCTION(NetMultiCast, Reliable)
+		void MultiCastFinishRespawn();
+
+	//히트 시 소유 클라이언트에게 고통을 준다
 	UFUNCTION(Client, Reliable)
 		void PlayPain();
 
 public:
 
-	//  
+	//팀 색상 결정
 	UFUNCTION(NetMultiCast, Reliable)
 		void SetTeam(ETeam NewTeam);
 
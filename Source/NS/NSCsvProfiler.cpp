@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSCsvProfiler.h"
+#include "NS.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+
+bool FNSCsvProfiler::bCapturing = false;
+uint32 FNSCsvProfiler::CategoryCycles[(int32)ENSCsvCategory::Count] = {};
+int32 FNSCsvProfiler::CurrentCategory = INDEX_NONE;
+uint32 FNSCsvProfiler::CurrentStartCycles = 0;
+
+namespace
+{
+	FString CsvPath;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PreExitHandle;
+	uint64 FirstFrame = 0;
+	double LastFrameTime = 0.0;
+
+	/** 기록하는 동안 열어 둔다. 닫을 때 남은 버퍼가 파일에 쓰인다 */
+	FArchive* CsvWriter = nullptr;
+
+	/** ASCII 한 줄을 그대로 쓴다 */
+	void WriteLine(const ANSICHAR* Line, int32 Length)
+	{
+		CsvWriter->Serialize(const_cast<ANSICHAR*>(Line), FMath::Max(Length, 0));
+	}
+}
+
+const TCHAR* FNSCsvProfiler::GetCategoryName(ENSCsvCategory Category)
+{
+	static const TCHAR* Names[] = { TEXT("shooting"), TEXT("damage"), TEXT("spawning"), TEXT("effects"), TEXT("hud") };
+	static_assert(ARRAY_COUNT(Names) == (int32)ENSCsvCategory::Count, "Add a name for each CSV category");
+	return Names[(int32)Category];
+}
+
+void FNSCsvProfiler::StartIfRequested()
+{
+	FString Path;
+	if (!bCapturing && FParse::Value(FCommandLine::Get(), TEXT("NSCsvProfile="), Path)) {
+		Start(Path);
+	}
+}
+
+void FNSCsvProfiler::Start(const FString& Path)
+{
+	Stop();
+
+	CsvPath = FPaths::ConvertRelativePathToFull(Path);
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(CsvPath), true);
+	CsvWriter = IFileManager::Get().CreateFileWriter(*CsvPath);
+	if (CsvWriter == nullptr) {
+		UE_LOG(LogTemp, Warning, TEXT("CSV profile: could not write %s"), *CsvPath);
+		return;
+	}
+	FString Header = TEXT("frame,frame_ms");
+	for (int32 i = 0; i < (int32)ENSCsvCategory::Count; i++) {
+		Header += FString::Printf(TEXT(",%s_ms"), GetCategoryName((ENSCsvCategory)i));
+	}
+	Header += TEXT("\n");
+	WriteLine(TCHAR_TO_ANSI(*Header), Header.Len());
+
+	FMemory::Memzero(CategoryCycles);
+	CurrentCategory = INDEX_NONE;
+	FirstFrame = GFrameCounter;
+	LastFrameTime = FPlatformTime::Seconds();
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FNSCsvProfiler::OnEndFrame);
+	//종료할 때 아카이브 버퍼에 남은 줄을 잃지 않도록 한 번만 등록해 둔다. Stop은 여러 번 불려도 된다
+	if (!PreExitHandle.IsValid()) {
+		PreExitHandle = FCoreDelegates::OnPreExit.AddStatic(&FNSCsvProfiler::Stop);
+	}
+	bCapturing = true;
+
+	UE_LOG(LogTemp, Display, TEXT("CSV profile: writing %s"), *CsvPath);
+}
+
+void FNSCsvProfiler::Stop()
+{
+	if (!bCapturing) {
+		return;
+	}
+	bCapturing = false;
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	//닫으면서 아카이브 버퍼에 남은 줄이 써진다
+	CsvWriter->Close();
+	delete CsvWriter;
+	CsvWriter = nullptr;
+	UE_LOG(LogTemp, Display, TEXT("CSV profile: stopped after %llu frames"), GFrameCounter - FirstFrame);
+}
+
+void FNSCsvProfiler::OnEndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+	//프레임 끝에서 열려 있는 범위는 없지만, 있더라도 여기까지를 이번 프레임에 넣는다
+	if (CurrentCategory != INDEX_NONE) {
+		SwitchCategory(CurrentCategory);
+	}
+
+	//힙을 쓰지 않도록 스택 버퍼에 숫자로 적는다
+	ANSICHAR Line[256];
+	int32 Length = FCStringAnsi::Snprintf(Line, sizeof(Line), "%llu,%.3f", GFrameCounter - FirstFrame, (Now - LastFrameTime) * 1000.0);
+	for (uint32& Cycles : CategoryCycles) {
+		Length += FCStringAnsi::Snprintf(Line + Length, sizeof(Line) - Length, ",%.3f", FPlatformTime::ToMilliseconds(Cycles));
+		Cycles = 0;
+	}
+	Length += FCStringAnsi::Snprintf(Line + Length, sizeof(Line) - Length, "\n");
+	WriteLine(Line, Length);
+	LastFrameTime = Now;
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithArgs NSCsvProfileCommand(
+	TEXT("ns.CsvProfile"),
+	TEXT("Writes per-frame game thread time per NS category to a CSV. Summarize with -run=NSCsvSummary. Args: start [Path] | stop"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0] == TEXT("stop")) {
+			FNSCsvProfiler::Stop();
+			return;
+		}
+		const FString Path = Args.Num() > 1 ? Args[1] : FPaths::ProfilingDir() / FString::Printf(TEXT("NS_%s.csv"), *FDateTime::Now().ToString());
+		FNSCsvProfiler::Start(Path);
+	})
+);
+
+#endif
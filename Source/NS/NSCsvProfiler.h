@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** CSV 프로파일러 열. 게임플레이 핫 패스를 몇 묶음으로 나눈다 */
+enum class ENSCsvCategory : uint8
+{
+	Shooting,
+	Damage,
+	Spawning,
+	Effects,
+	HUD,
+
+	Count
+};
+
+/**
+ * 프레임마다 한 줄씩 카테고리별 게임 스레드 시간을 CSV로 남긴다.
+ * -NSCsvProfile=<경로>로 실행하거나 ns.CsvProfile start로 켠다. 전용 서버에서도 돈다.
+ * 카테고리 열은 배타 시간이다. 다른 카테고리 범위가 안에서 돌면 그동안은 안쪽 카테고리에만 더하므로 열의 합은 프레임 시간을 넘지 않는다.
+ * 프레임마다 한 줄을 스택 버퍼에 적어 기록 내내 열어 두는 파일 아카이브에 넘긴다.
+ * 아카이브가 몇 KB씩 모아 쓰므로 게임 스레드가 한 번에 디스크로 보내는 양이 작아서 프레임 시간 열이 튀지 않는다.
+ * 요약은 NSCsvSummary 커맨드렛으로 낸다.
+ */
+class NS_API FNSCsvProfiler
+{
+public:
+	/** 명령줄에 -NSCsvProfile=<경로>가 있으면 기록을 시작한다 */
+	static void StartIfRequested();
+
+	static void Start(const FString& Path);
+	static void Stop();
+
+	static bool IsCapturing() { return bCapturing; }
+
+	static const TCHAR* GetCategoryName(ENSCsvCategory Category);
+
+private:
+	friend struct FNSCsvScope;
+
+	static void OnEndFrame();
+
+	static bool bCapturing;
+
+	/** 이번 프레임 카테고리별 누적 사이클. 게임 스레드에서만 쓴다 */
+	static uint32 CategoryCycles[(int32)ENSCsvCategory::Count];
+
+	/** 지금 시간을 받고 있는 카테고리(없으면 INDEX_NONE)와 그 카테고리로 바뀐 시각 */
+	static int32 CurrentCategory;
+	static uint32 CurrentStartCycles;
+
+	/** 지금 카테고리에 지금까지의 시간을 더하고 NewCategory로 바꾼다 */
+	static void SwitchCategory(int32 NewCategory)
+	{
+		const uint32 Now = FPlatformTime::Cycles();
+		if (CurrentCategory != INDEX_NONE) {
+			CategoryCycles[CurrentCategory] += Now - CurrentStartCycles;
+		}
+		CurrentCategory = NewCategory;
+		CurrentStartCycles = Now;
+	}
+};
+
+/**
+ * 범위 시간을 카테고리에 더한다. 바깥 카테고리는 이 범위 동안 멈췄다가 끝나면 다시 센다.
+ * 같은 카테고리 안에서 다시 열면 아무것도 바꾸지 않는다.
+ */
+struct FNSCsvScope
+{
+	explicit FNSCsvScope(ENSCsvCategory InCategory)
+		: ParentCategory(INDEX_NONE)
+		, bSwitched(FNSCsvProfiler::bCapturing && IsInGameThread() && FNSCsvProfiler::CurrentCategory != (int32)InCategory)
+	{
+		if (bSwitched) {
+			ParentCategory = FNSCsvProfiler::CurrentCategory;
+			FNSCsvProfiler::SwitchCategory((int32)InCategory);
+		}
+	}
+
+	~FNSCsvScope()
+	{
+		if (bSwitched) {
+			FNSCsvProfiler::SwitchCategory(ParentCategory);
+		}
+	}
+
+private:
+	int32 ParentCategory;
+	const bool bSwitched;
+};
+
+#define NS_CSV_SCOPE(Category) FNSCsvScope PREPROCESSOR_JOIN(NSCsvScope_, __LINE__)(ENSCsvCategory::Category)
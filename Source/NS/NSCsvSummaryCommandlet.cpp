@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSCsvSummaryCommandlet.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UNSCsvSummaryCommandlet::UNSCsvSummaryCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNSCsvSummaryCommandlet::Main(const FString& Params)
+{
+	FString CsvPath;
+	if (!FParse::Value(*Params, TEXT("Csv="), CsvPath)) {
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=NSCsvSummary -Csv=<file.csv> [-Out=<summary.csv>] [-SkipFrames=<N>]"));
+		return 1;
+	}
+	int32 SkipFrames = 0;
+	FParse::Value(*Params, TEXT("SkipFrames="), SkipFrames);
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *CsvPath) || Lines.Num() < 2) {
+		UE_LOG(LogTemp, Error, TEXT("Could not read %s or it has no rows"), *CsvPath);
+		return 1;
+	}
+
+	TArray<FString> Columns;
+	Lines[0].ParseIntoArray(Columns, TEXT(","), false);
+	TArray<TArray<float>> Values;
+	Values.SetNum(Columns.Num());
+
+	TArray<FString> Fields;
+	for (int32 Line = 1 + SkipFrames; Line < Lines.Num(); Line++) {
+		Lines[Line].ParseIntoArray(Fields, TEXT(","), false);
+		for (int32 Column = 0; Column < FMath::Min(Fields.Num(), Columns.Num()); Column++) {
+			Values[Column].Add(FCString::Atof(*Fields[Column]));
+		}
+	}
+
+	FString Summary = TEXT("column,samples,p50,p95,p99,max,mean\n");
+	UE_LOG(LogTemp, Display, TEXT("%-24s %8s %10s %10s %10s %10s %10s"), TEXT("Column"), TEXT("Samples"), TEXT("p50"), TEXT("p95"), TEXT("p99"), TEXT("max"), TEXT("mean"));
+	for (int32 Column = 0; Column < Columns.Num(); Column++) {
+		TArray<float>& Samples = Values[Column];
+		if (Columns[Column] == TEXT("frame") || Columns[Column] == TEXT("time_s") || Samples.Num() == 0) {
+			continue;
+		}
+
+		Samples.Sort();
+		auto Percentile = [&Samples](float P)
+		{
+			return Samples[FMath::Min(FMath::FloorToInt(P * Samples.Num()), Samples.Num() - 1)];
+		};
+		double Sum = 0.0;
+		for (float Sample : Samples) {
+			Sum += Sample;
+		}
+		const double Mean = Sum / Samples.Num();
+
+		UE_LOG(LogTemp, Display, TEXT("%-24s %8d %10.3f %10.3f %10.3f %10.3f %10.3f"),
+			*Columns[Column], Samples.Num(), Percentile(0.5f), Percentile(0.95f), Percentile(0.99f), Samples.Last(), Mean);
+		Summary += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+			*Columns[Column], Samples.Num(), Percentile(0.5f), Percentile(0.95f), Percentile(0.99f), Samples.Last(), Mean);
+	}
+
+	FString OutPath;
+	if (FParse::Value(*Params, TEXT("Out="), OutPath)) {
+		if (!FFileHelper::SaveStringToFile(Summary, *OutPath)) {
+			UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *OutPath);
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Wrote %s"), *OutPath);
+	}
+	return 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NSCsvSummaryCommandlet.generated.h"
+
+/**
+ * 프레임별 CSV를 열마다 p50/p95/p99/최대/평균으로 요약한다.
+ * UE4Editor-Cmd NS -run=NSCsvSummary -Csv=<경로> [-Out=<요약 csv>] [-SkipFrames=<앞에서 버릴 줄 수>]
+ * ns.CsvProfile과 -NSLoadTestCsv가 만든 파일을 모두 읽는다. frame, time_s 열은 건너뛴다.
+ */
+UCLASS()
+class UNSCsvSummaryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UNSCsvSummaryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSEffectPool.h"
+#include "NS.h"
+#include "NSGameState.h"
+#include "Components/AudioComponent.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundBase.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Hits"), STAT_NSEffectPoolHits, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Misses"), STAT_NSEffectPoolMisses, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Evictions"), STAT_NSEffectPoolEvictions, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Culled"), STAT_NSEffectPoolCulled, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Components"), STAT_NSEffectPoolComponents, STATGROUP_NS);
+
+namespace
+{
+	/**
+	 * 풀에서 쉬고 있는 컴포넌트를 고른다. 없으면 새로 만들고, 한도에 걸리면 가장 오래전에 쓴 것을 뺏는다.
+	 * IsIdle(Comp)는 재사용 가능한지, Create()는 새 컴포넌트를 만든다.
+	 */
+	template<typename ComponentType, typename IsIdleType, typename CreateType>
+	ComponentType* Acquire(TArray<ComponentType*>& Components, TArray<float>& LastUsed, int32 MaxInstances, float Now, IsIdleType IsIdle, CreateType Create)
+	{
+		int32 Oldest = INDEX_NONE;
+		for (int32 i = 0; i < Components.Num(); i++) {
+			if (IsIdle(Components[i])) {
+				INC_DWORD_STAT(STAT_NSEffectPoolHits);
+				LastUsed[i] = Now;
+				return Components[i];
+			}
+			if (Oldest == INDEX_NONE || LastUsed[i] < LastUsed[Oldest]) {
+				Oldest = i;
+			}
+		}
+
+		if (Components.Num() < MaxInstances) {
+			INC_DWORD_STAT(STAT_NSEffectPoolMisses);
+			INC_DWORD_STAT(STAT_NSEffectPoolComponents);
+			Components.Add(Create());
+			LastUsed.Add(Now);
+			return Components.Last();
+		}
+
+		if (Oldest == INDEX_NONE) {
+			return nullptr;
+		}
+		INC_DWORD_STAT(STAT_NSEffectPoolEvictions);
+		LastUsed[Oldest] = Now;
+		return Components[Oldest];
+	}
+}
+
+ANSEffectPool::ANSEffectPool()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	MaxInstancesPerTemplate = 16;
+	CullDistance = 10000.0f;
+	MinScreenSize = 0.002f;
+	EffectRadius = 50.0f;
+}
+
+ANSEffectPool* ANSEffectPool::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer) {
+		return nullptr;
+	}
+
+	//게임 스테이트는 서버와 클라이언트 모두에 있으므로 거기에 달아 둔다
+	ANSGameState* thisGameState = World->GetGameState<ANSGameState>();
+	if (thisGameState == nullptr) {
+		return nullptr;
+	}
+	if (thisGameState->EffectPool == nullptr) {
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		thisGameState->EffectPool = World->SpawnActor<ANSEffectPool>(SpawnParams);
+	}
+	return thisGameState->EffectPool;
+}
+
+bool ANSEffectPool::ShouldCull(const FVector& Location, bool bCheckScreenSize) const
+{
+	APlayerController* thisPC = GetWorld()->GetFirstPlayerController();
+	if (thisPC == nullptr || thisPC->PlayerCameraManager == nullptr) {
+		return false;
+	}
+
+	const FVector ViewLocation = thisPC->PlayerCameraManager->GetCameraLocation();
+	const float DistSquared = FVector::DistSquared(ViewLocation, Location);
+	if (DistSquared > FMath::Square(CullDistance)) {
+		return true;
+	}
+
+	if (bCheckScreenSize) {
+		//반경을 시야 절반 높이에 대한 비율로 근사한다
+		const float HalfFOV = FMath::DegreesToRadians(thisPC->PlayerCameraManager->GetFOVAngle() * 0.5f);
+		const float Distance = FMath::Max(FMath::Sqrt(DistSquared), 1.0f);
+		const float ScreenSize = EffectRadius / (Distance * FMath::Tan(HalfFOV));
+		if (ScreenSize < MinScreenSize) {
+			return true;
+		}
+	}
+	return false;
+}
+
+UParticleSystemComponent* ANSEffectPool::SpawnParticle(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	if (Template == nullptr) {
+		return nullptr;
+	}
+	if (ShouldCull(Location, true)) {
+		INC_DWORD_STAT(STAT_NSEffectPoolCulled);
+		return nullptr;
+	}
+
+	FNSParticlePool& Pool = ParticlePools.FindOrAdd(Template);
+	UParticleSystemComponent* Comp = Acquire(Pool.Components, Pool.LastUsed, MaxInstancesPerTemplate, GetWorld()->GetTimeSeconds(),
+		[](UParticleSystemComponent* Candidate) { return !Candidate->IsActive(); },
+		[this, Template]()
+		{
+			UParticleSystemComponent* NewComp = NewObject<UParticleSystemComponent>(this);
+			NewComp->bAutoActivate = false;
+			NewComp->bAutoDestroy = false;
+			NewComp->SetAbsolute(true, true, true);
+			NewComp->SetTemplate(Template);
+			NewComp->RegisterComponent();
+			return NewComp;
+		});
+
+	if (Comp) {
+		Comp->SetWorldLocationAndRotation(Location, Rotation);
+		Comp->ActivateSystem(true);
+	}
+	return Comp;
+}
+
+UAudioComponent* ANSEffectPool::PlaySound(USoundBase* Sound, const FVector& Location)
+{
+	if (Sound == nullptr) {
+		return nullptr;
+	}
+	if (ShouldCull(Location, false)) {
+		INC_DWORD_STAT(STAT_NSEffectPoolCulled);
+		return nullptr;
+	}
+
+	FNSAudioPool& Pool = AudioPools.FindOrAdd(Sound);
+	UAudioComponent* Comp = Acquire(Pool.Components, Pool.LastUsed, MaxInstancesPerTemplate, GetWorld()->GetTimeSeconds(),
+		[](UAudioComponent* Candidate) { return !Candidate->IsPlaying(); },
+		[this, Sound]()
+		{
+			UAudioComponent* NewComp = NewObject<UAudioComponent>(this);
+			NewComp->bAutoActivate = false;
+			NewComp->bAutoDestroy = false;
+			NewComp->SetAbsolute(true, true, true);
+			NewComp->SetSound(Sound);
+			NewComp->RegisterComponent();
+			return NewComp;
+		});
+
+	if (Comp) {
+		Comp->SetWorldLocation(Location);
+		Comp->Play();
+	}
+	return Comp;
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NSEffectPool.generated.h"
+
+/** 템플릿 하나에 대한 파티클 컴포넌트 풀 */
+USTRUCT()
+struct FNSParticlePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<class UParticleSystemComponent*> Components;
+
+	/** Components와 같은 순서의 마지막 활성화 시각(LRU용) */
+	TArray<float> LastUsed;
+};
+
+/** 사운드 하나에 대한 오디오 컴포넌트 풀 */
+USTRUCT()
+struct FNSAudioPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<class UAudioComponent*> Components;
+
+	TArray<float> LastUsed;
+};
+
+/**
+ * 월드마다 하나씩 있는 이펙트 풀.
+ * 발사/피격 이펙트를 매번 스폰하지 않고 템플릿별로 고정 개수의 컴포넌트를 재사용한다.
+ * 템플릿마다 동시 재생 수를 제한하고, 꽉 차면 가장 오래전에 쓴 컴포넌트를 뺏어 쓴다.
+ * 멀거나 화면에서 너무 작은 이펙트는 활성화하기 전에 버린다.
+ * 데디케이티드 서버에서는 아무것도 재생하지 않는다.
+ */
+UCLASS(config=Game)
+class NS_API ANSEffectPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSEffectPool();
+
+	/** 월드의 이펙트 풀을 얻는다. 없으면 만든다 */
+	static ANSEffectPool* Get(const UObject* WorldContextObject);
+
+	/** 풀에서 파티클을 꺼내 재생한다. 컬링됐거나 재생할 수 없으면 nullptr */
+	class UParticleSystemComponent* SpawnParticle(class UParticleSystem* Template, const FVector& Location, const FRotator& Rotation);
+
+	/** 풀에서 오디오 컴포넌트를 꺼내 재생한다. 컬링됐거나 재생할 수 없으면 nullptr */
+	class UAudioComponent* PlaySound(class USoundBase* Sound, const FVector& Location);
+
+	/** 템플릿마다 유지할 최대 컴포넌트 수(= 동시 재생 수) */
+	UPROPERTY(config, EditAnywhere, Category = EffectPool)
+	int32 MaxInstancesPerTemplate;
+
+	/** 이 거리보다 먼 이펙트는 재생하지 않는다 */
+	UPROPERTY(config, EditAnywhere, Category = EffectPool)
+	float CullDistance;
+
+	/** 이펙트 반경을 화면 높이 비율로 환산했을 때 이보다 작으면 파티클을 재생하지 않는다 */
+	UPROPERTY(config, EditAnywhere, Category = EffectPool)
+	float MinScreenSize;
+
+	/** 화면 크기 계산에 쓰는 이펙트 반경 */
+	UPROPERTY(config, EditAnywhere, Category = EffectPool)
+	float EffectRadius;
+
+private:
+	/** 뷰 위치를 기준으로 컬링할지 판단한다. bCheckScreenSize가 false면 거리만 본다 */
+	bool ShouldCull(const FVector& Location, bool bCheckScreenSize) const;
+
+	UPROPERTY()
+	TMap<class UParticleSystem*, FNSParticlePool> ParticlePools;
+
+	UPROPERTY()
+	TMap<class USoundBase*, FNSAudioPool> AudioPools;
+};
@@ -3,37 +3,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
+#include "NSSGameMode.h"
 #include "NSGameMode.generated.h"
 
-
-
+/**
+ * 예전 게임 모드 이름. 맵과 블루프린트가 이 클래스를 가리키고 있어서 남겨 둔다.
+ * 매치 진행은 모두 ANSSGameMode가 한다.
+ */
 UCLASS(minimalapi)
-class ANSGameMode : public AGameModeBase
+class ANSGameMode : public ANSSGameMode
 {
 	GENERATED_BODY()
 
 public:
 	ANSGameMode();
-	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
-	virtual void PostLogin(APlayerController* NewPlayer) override;
-	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
-
-	void Respawn(class ANSCharacter* Character);
-	void Spawn(class ANSCharacter* Character);
-
-private:
-	TArray<class ANSCharacter*> RedTeam;
-	TArray<class ANSCharacter*> BlueTeam;
-
-	TArray<class ANSSpawnPoint*> RedSpawn;
-	TArray<class ANSSpawnPoint*> BlueSpawn;
-	TArray<class ANSCharacter*> ToBeSpawned;
-
-	bool bGameStarted;
-	static bool bInGameMenu;
 };
-
-
-
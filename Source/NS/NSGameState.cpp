@@ -1,17 +1,88 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "NSGameState.h"
+#include "NSPlayerState.h"
+#include "NS.h"
 #include "Net/UnrealNetwork.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Team Materials Created"), STAT_NSTeamMaterialsCreated, STATGROUP_NS);
 
 
 ANSGameState::ANSGameState() {
 
-	bInMenu = false;
+	MatchPhase = ENSMatchPhase::Lobby;
+	PhaseEndTime = 0.0f;
+	EffectPool = nullptr;
+	RagdollBudget = nullptr;
 
 }
 
 void ANSGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&OutLifetimeProps) const {
 
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(ANSGameState, bInMenu);
-}
\ No newline at end of file
+	DOREPLIFETIME(ANSGameState, MatchPhase);
+	DOREPLIFETIME(ANSGameState, PhaseEndTime);
+}
+
+void ANSGameState::AddPlayerState(APlayerState* PlayerState)
+{
+	Super::AddPlayerState(PlayerState);
+	//클라이언트에서는 아직 기본값이고, 복제가 들어오면 OnRep에서 고쳐진다. 데디케이티드 서버는 그릴 HUD가 없어서 명단을 두지 않는다
+	if (GetNetMode() != NM_DedicatedServer) {
+		Scoreboard.Add(Cast<ANSPlayerState>(PlayerState));
+	}
+
+	//관전자는 이 플레이어의 체력을 먼저 받아 두었을 수 있으니 다시 채운다
+	if (Role < ROLE_Authority) {
+		APlayerController* thisPC = GetWorld()->GetFirstPlayerController();
+		ANSPlayerState* LocalPS = thisPC ? Cast<ANSPlayerState>(thisPC->PlayerState) : nullptr;
+		if (LocalPS && LocalPS != PlayerState) {
+			LocalPS->ApplySpectatedHealth();
+		}
+	}
+}
+
+void ANSGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	Super::RemovePlayerState(PlayerState);
+	if (GetNetMode() != NM_DedicatedServer) {
+		Scoreboard.Remove(Cast<ANSPlayerState>(PlayerState));
+	}
+}
+
+void ANSGameState::UpdateScoreboard(ANSPlayerState* PlayerState)
+{
+	if (GetNetMode() != NM_DedicatedServer) {
+		Scoreboard.Update(PlayerState);
+	}
+}
+
+UMaterialInterface* ANSGameState::GetTeamMaterial(ETeam Team, UMaterialInterface* BaseMaterial)
+{
+	if (BaseMaterial == nullptr) {
+		return nullptr;
+	}
+
+	static const FLinearColor TeamColors[] = { FLinearColor(0.0f, 0.0f, 0.5f), FLinearColor(0.5f, 0.0f, 0.0f) };
+	static_assert(ARRAY_COUNT(TeamColors) == (int32)ETeam::TEAM_COUNT, "Add a color for each team");
+	const int32 TeamIndex = (int32)Team;
+	if (TeamIndex >= (int32)ETeam::TEAM_COUNT) {
+		return BaseMaterial;
+	}
+
+	//원래 머티리얼이 다른 메시끼리 서로의 머티리얼을 덮어쓰지 않도록 원래 머티리얼별로 따로 둔다
+	FNSTeamMaterialSet& TeamMaterialSet = TeamMaterials.FindOrAdd(BaseMaterial);
+	if (TeamMaterialSet.Materials.Num() != (int32)ETeam::TEAM_COUNT) {
+		TeamMaterialSet.Materials.SetNumZeroed((int32)ETeam::TEAM_COUNT);
+	}
+	UMaterialInstanceDynamic*& TeamMaterial = TeamMaterialSet.Materials[TeamIndex];
+	if (TeamMaterial == nullptr) {
+		TeamMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, this);
+		TeamMaterial->SetVectorParameterValue(TEXT("BodyColor"), TeamColors[TeamIndex]);
+		INC_DWORD_STAT(STAT_NSTeamMaterialsCreated);
+	}
+	return TeamMaterial;
+}
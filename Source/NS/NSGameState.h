@@ -4,8 +4,28 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameState.h"
+#include "NSScoreboard.h"
 #include "NSGameState.generated.h"
 
+/** 매치 진행 단계. 로비 맵에서는 Lobby, 매치 맵에서는 Warmup -> Live -> Post 순서로 간다 */
+UENUM(BlueprintType)
+enum class ENSMatchPhase : uint8 {
+	Lobby,
+	Warmup,
+	Live,
+	Post
+};
+
+/** 원래 머티리얼 하나에 대한 팀별 색상 머티리얼. ETeam 순서 */
+USTRUCT()
+struct FNSTeamMaterialSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<class UMaterialInstanceDynamic*> Materials;
+};
+
 /**
  * 
  */
@@ -17,8 +37,42 @@ class NS_API ANSGameState : public AGameState
 public:
 	ANSGameState();
 
+	virtual void AddPlayerState(APlayerState* PlayerState) override;
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+
+	/** 팀별로 정렬된 명단. HUD와 스코어보드는 PlayerArray 대신 이걸 읽는다. 데디케이티드 서버에서는 비어 있다 */
+	const FNSScoreboard& GetScoreboard() const { return Scoreboard; }
+
+	/** 플레이어 상태의 표시 값이 바뀌었을 때 부른다 */
+	void UpdateScoreboard(class ANSPlayerState* PlayerState);
+
+	/**
+	 * 팀 색상 머티리얼. 월드마다 원래 머티리얼과 팀 조합당 하나만 만들고 모든 캐릭터가 같이 쓴다.
+	 * 같은 팀 메시는 같은 머티리얼을 쓰므로 그릴 때 상태가 바뀌지 않는다.
+	 */
+	class UMaterialInterface* GetTeamMaterial(ETeam Team, class UMaterialInterface* BaseMaterial);
+
+	UPROPERTY(Replicated)
+		ENSMatchPhase MatchPhase;
+
+	/** 현재 단계가 끝나는 서버 시각. 0이면 정해진 끝이 없다 */
 	UPROPERTY(Replicated)
-		bool bInMenu;
+		float PhaseEndTime;
+
+	/** 이 월드의 이펙트 풀. ANSEffectPool::Get()이 처음 호출될 때 만든다 */
+	UPROPERTY(Transient)
+		class ANSEffectPool* EffectPool;
+
+	/** 이 월드의 래그돌 예산. ANSRagdollBudget::Get()이 처음 호출될 때 만든다 */
+	UPROPERTY(Transient)
+		class ANSRagdollBudget* RagdollBudget;
+
+private:
+	FNSScoreboard Scoreboard;
+
+	/** 원래 머티리얼별 팀 색상 머티리얼. 팀 수는 ETeam에서 정한다 */
+	UPROPERTY(Transient)
+	TMap<class UMaterialInterface*, FNSTeamMaterialSet> TeamMaterials;
 	
 	
 };
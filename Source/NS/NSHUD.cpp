@@ -2,33 +2,130 @@
 
 #include "NSHUD.h"
 #include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+#include "Engine/Font.h"
 #include "Engine/Texture2D.h"
+#include "GameFramework/PlayerController.h"
 #include "TextureResource.h"
-#include "CanvasItem.h"
 #include "UObject/ConstructorHelpers.h"
 #include "NSCharacter.h"
-#include "NSGameState.h"
 #include "NSSGameMode.h"
 #include "NSPlayerState.h"
-#include "Kismet/GameplayStatics.h"
+#include "NS.h"
+#include "NSCsvProfiler.h"
+#include "HAL/IConsoleManager.h"
+#include "NSAllocCounter.h"
+
+DECLARE_CYCLE_STAT(TEXT("HUD Draw"), STAT_NSHUDDraw, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("HUD Text Rebuilds"), STAT_NSHUDTextRebuilds, STATGROUP_NS);
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	int32 HUDAllocFramesLeft = 0;
+	int32 HUDAllocFrames = 0;
+	int32 HUDAllocTotal = 0;
+	int32 HUDAllocMaxPerFrame = 0;
+	int32 CanvasAllocTotal = 0;
+
+	void StopHUDAllocCount(const TCHAR* Reason)
+	{
+		HUDAllocFramesLeft = 0;
+		UE_LOG(LogTemp, Display, TEXT("ns.HUDAllocs: HUD code made %d allocations over %d frames (max %d in one frame), canvas DrawItem made %d%s"),
+			HUDAllocTotal, HUDAllocFrames, HUDAllocMaxPerFrame, CanvasAllocTotal, Reason);
+	}
+
+	/** DrawHUD가 끝날 때 그 프레임의 할당 수를 더한다 */
+	void RecordHUDAllocs(int32 HUDAllocs, int32 CanvasAllocs)
+	{
+		if (HUDAllocFramesLeft <= 0) {
+			return;
+		}
+		HUDAllocTotal += HUDAllocs;
+		HUDAllocMaxPerFrame = FMath::Max(HUDAllocMaxPerFrame, HUDAllocs);
+		CanvasAllocTotal += CanvasAllocs;
+		HUDAllocFrames++;
+		if (--HUDAllocFramesLeft == 0) {
+			StopHUDAllocCount(TEXT(""));
+		}
+	}
+}
+
+static FAutoConsoleCommandWithArgs NSHUDAllocsCommand(
+	TEXT("ns.HUDAllocs"),
+	TEXT("Sums the heap allocations the HUD makes over the next Frames draws, split into the HUD's own code and its canvas DrawItem calls. Text rebuilds show up as nonzero HUD frames. Args: [Frames=300] | stop"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0] == TEXT("stop")) {
+			if (HUDAllocFramesLeft > 0) {
+				StopHUDAllocCount(TEXT(" (stopped)"));
+			}
+			return;
+		}
+		HUDAllocFrames = 0;
+		HUDAllocTotal = 0;
+		HUDAllocMaxPerFrame = 0;
+		CanvasAllocTotal = 0;
+		HUDAllocFramesLeft = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300, 1);
+	})
+);
+#endif
 
 ANSHUD::ANSHUD()
 {
 	// Set the crosshair texture
 	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("/Game/FirstPerson/Textures/FirstPersonCrosshair"));
 	CrosshairTex = CrosshairTexObj.Object;
-}
 
+	CachedGameState = nullptr;
+	CachedPlayerState = nullptr;
+	CachedPawn = nullptr;
+	CachedCharacter = nullptr;
+	CachedPhase = ENSMatchPhase::Lobby;
+	CachedScoreboardRevision = 0;
+	CachedStatsRevision = 0;
+	CachedRemainingSeconds = 0;
+	CachedClipSize = FVector2D::ZeroVector;
+	bTextDirty = true;
+#if !UE_BUILD_SHIPPING
+	LastHUDAllocs = 0;
+	LastCanvasAllocs = 0;
+#endif
+}
 
 void ANSHUD::DrawHUD()
 {
 	Super::DrawHUD();
 
-	// Draw very simple crosshair
+	SCOPE_CYCLE_COUNTER(STAT_NSHUDDraw);
+	NS_CSV_SCOPE(HUD);
 
 	// find center of the Canvas
 	const FVector2D Center(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f);
 
+	{
+#if !UE_BUILD_SHIPPING
+		FNSAllocCountScope AllocCount;
+#endif
+		//폰은 리스폰으로 바뀔 수 있으니 포인터가 바뀌었을 때만 다시 캐스트한다
+		APawn* thisPawn = PlayerOwner ? PlayerOwner->GetPawn() : nullptr;
+		if (thisPawn != CachedPawn) {
+			CachedPawn = thisPawn;
+			CachedCharacter = Cast<ANSCharacter>(thisPawn);
+		}
+
+		UpdateTextItems(Center);
+#if !UE_BUILD_SHIPPING
+		LastHUDAllocs = AllocCount.GetCount();
+#endif
+	}
+
+#if !UE_BUILD_SHIPPING
+	FNSAllocCountScope CanvasAllocCount;
+#endif
+
+	// Draw very simple crosshair
+
 	// offset by half the texture's dimensions so that the center of the texture aligns with the center of the Canvas
 	const FVector2D CrosshairDrawPosition( (Center.X),
 										   (Center.Y + 20.0f));
@@ -38,55 +135,117 @@ void ANSHUD::DrawHUD()
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
 
-	ANSGameState* thisGameState = Cast<ANSGameState>(GetWorld()->GetGameState());
-
-	if (thisGameState != nullptr&& thisGameState->bInMenu) {
-		int BlueScreenPos = 50;
-		int RedScreenPos = Center.Y + 50;
-		int nameSpacing = 25;
-		int NumBlueteam = 1;
-		int NumRedteam = 1;
-
-		FString thisString = "BLUE TEAM:";
-		DrawText(thisString, FColor::Cyan, 50, BlueScreenPos);
-
-		thisString = "RED TEAM";
-		DrawText(thisString, FColor::Red, 50, RedScreenPos);
-
-		for (auto player : thisGameState->PlayerArray) {
-			ANSPlayerState* thisPS = Cast<ANSPlayerState>(player);
-			if (thisPS) {
-				if (thisPS->Team == ETeam::BLUE_TEAM) {
-					thisString = FString::Printf(TEXT("%s"), *thisPS->GetPlayerName());
-					DrawText(thisString, FColor::Cyan, 50, BlueScreenPos + nameSpacing * NumBlueteam);
-					NumBlueteam++;
-				}
-				else {
-					thisString = FString::Printf(TEXT("%S"), *thisPS->GetPlayerName());
-					DrawText(thisString, FColor::Red, 50, RedScreenPos + nameSpacing * NumRedteam);
-					NumRedteam++;
-				}
-			}
+	//로비가 아니면 예전처럼 캐릭터가 있을 때만 글자를 그린다.
+	//글꼴 텍스처와 블렌드가 같은 아이템은 캔버스가 바로 앞 배치에 이어 붙이므로 글자는 모두 한 번에 그려진다
+	if (CachedPhase == ENSMatchPhase::Lobby || CachedCharacter != nullptr) {
+		for (FCanvasTextItem& TextItem : TextItems) {
+			Canvas->DrawItem(TextItem);
 		}
+	}
 
-		if (GetWorld()->GetAuthGameMode()) {
-			thisString = "Press R to Start Game";
-			DrawText(thisString, FColor::Yellow, Center.X, Center.Y);
+	//예측 히트 마커. 서버가 되돌린 히트는 그리지 않는다
+	if (CachedPhase != ENSMatchPhase::Lobby && CachedCharacter != nullptr && CachedCharacter->HasActiveHitMarker()) {
+		const FVector2D MarkerCenter(CrosshairDrawPosition.X + CrosshairTex->GetSurfaceWidth() * 0.5f, CrosshairDrawPosition.Y + CrosshairTex->GetSurfaceHeight() * 0.5f);
+		const float Inner = 6.0f;
+		const float Outer = 14.0f;
+		for (int32 Corner = 0; Corner < 4; Corner++) {
+			const FVector2D Sign(Corner & 1 ? 1.0f : -1.0f, Corner & 2 ? 1.0f : -1.0f);
+			FCanvasLineItem LineItem(MarkerCenter + Sign * Outer, MarkerCenter + Sign * Inner);
+			LineItem.SetColor(FLinearColor::White);
+			LineItem.LineThickness = 2.0f;
+			Canvas->DrawItem(LineItem);
 		}
-		else {
-			thisString = "Waiting On Server!!";
-			DrawText(thisString, FColor::Yellow, Center.X, Center.Y);
+	}
+
+#if !UE_BUILD_SHIPPING
+	LastCanvasAllocs = CanvasAllocCount.GetCount();
+	RecordHUDAllocs(LastHUDAllocs, LastCanvasAllocs);
+#endif
+}
+
+void ANSHUD::UpdateTextItems(const FVector2D& Center)
+{
+	AGameStateBase* thisGameStateBase = GetWorld()->GetGameState();
+	if (thisGameStateBase != CachedGameState) {
+		CachedGameState = Cast<ANSGameState>(thisGameStateBase);
+		bTextDirty = true;
+	}
+	APlayerState* thisPlayerState = PlayerOwner ? PlayerOwner->PlayerState : nullptr;
+	if (thisPlayerState != CachedPlayerState) {
+		CachedPlayerState = Cast<ANSPlayerState>(thisPlayerState);
+		bTextDirty = true;
+	}
+
+	const ENSMatchPhase Phase = CachedGameState ? CachedGameState->MatchPhase : ENSMatchPhase::Live;
+	const uint32 ScoreboardRevision = CachedGameState ? CachedGameState->GetScoreboard().GetRevision() : 0;
+	const uint32 StatsRevision = CachedPlayerState ? CachedPlayerState->GetRevision() : 0;
+	int32 RemainingSeconds = 0;
+	if (CachedGameState && Phase != ENSMatchPhase::Live && CachedGameState->PhaseEndTime > 0.0f) {
+		RemainingSeconds = FMath::RoundToInt(FMath::Max(CachedGameState->PhaseEndTime - CachedGameState->GetServerWorldTimeSeconds(), 0.0f));
+	}
+	const FVector2D ClipSize(Canvas->ClipX, Canvas->ClipY);
+
+	//로비 명단은 스코어보드 리비전만, 매치 중에는 내 플레이어 상태의 리비전만 본다
+	const bool bLobby = Phase == ENSMatchPhase::Lobby;
+	if (bTextDirty || Phase != CachedPhase || ClipSize != CachedClipSize || RemainingSeconds != CachedRemainingSeconds
+		|| (bLobby && ScoreboardRevision != CachedScoreboardRevision) || (!bLobby && StatsRevision != CachedStatsRevision)) {
+		CachedPhase = Phase;
+		CachedScoreboardRevision = ScoreboardRevision;
+		CachedStatsRevision = StatsRevision;
+		CachedRemainingSeconds = RemainingSeconds;
+		CachedClipSize = ClipSize;
+		bTextDirty = false;
+		RebuildTextItems(Center);
+	}
+}
+
+void ANSHUD::RebuildTextItems(const FVector2D& Center)
+{
+	INC_DWORD_STAT(STAT_NSHUDTextRebuilds);
+	TextItems.Reset();
+
+	if (CachedGameState != nullptr && CachedPhase == ENSMatchPhase::Lobby) {
+		const float BlueScreenPos = 50.0f;
+		const float RedScreenPos = Center.Y + 50.0f;
+		const float nameSpacing = 25.0f;
+
+		AddTextItem(TEXT("BLUE TEAM:"), FColor::Cyan, 50.0f, BlueScreenPos);
+		AddTextItem(TEXT("RED TEAM"), FColor::Red, 50.0f, RedScreenPos);
+
+		const FNSScoreboard& Scoreboard = CachedGameState->GetScoreboard();
+		const TArray<FNSScoreboardRow>& BlueRows = Scoreboard.GetTeam(ETeam::BLUE_TEAM);
+		for (int32 i = 0; i < BlueRows.Num(); i++) {
+			AddTextItem(BlueRows[i].Name, FColor::Cyan, 50.0f, BlueScreenPos + nameSpacing * (i + 1));
 		}
-	}//(thisGameState != nullptr&&thisGameState->bInMenu)ݱ
-
-	else {
-		ANSCharacter* ThisChar = Cast<ANSCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
-		if (ThisChar != nullptr) {
-			if (ThisChar->GetNSPlayerState()) {
-				FString HUDString = FString::Printf(TEXT("Health: %f, Score: %.0f, Deaths: %d"), ThisChar->GetNSPlayerState()->Health,
-					ThisChar->GetNSPlayerState()->Score, ThisChar->GetNSPlayerState()->Deaths);
-				DrawText(HUDString, FColor::Yellow, 50, 50);
-			}
+		const TArray<FNSScoreboardRow>& RedRows = Scoreboard.GetTeam(ETeam::RED_TEAM);
+		for (int32 i = 0; i < RedRows.Num(); i++) {
+			AddTextItem(RedRows[i].Name, FColor::Red, 50.0f, RedScreenPos + nameSpacing * (i + 1));
 		}
+
+		AddTextItem(GetWorld()->GetAuthGameMode() ? TEXT("Press Enter to Start Game") : TEXT("Waiting On Server!!"), FColor::Yellow, Center.X, Center.Y, true);
+		return;
+	}
+
+	if (CachedPlayerState) {
+		AddTextItem(FString::Printf(TEXT("Health: %f, Score: %.0f, Deaths: %d"), CachedPlayerState->GetHealth(),
+			CachedPlayerState->Score, CachedPlayerState->GetDeaths()), FColor::Yellow, 50.0f, 50.0f);
+	}
+
+	//워밍업과 매치 종료 후에는 남은 시간을 보여준다
+	if (CachedGameState != nullptr && CachedPhase != ENSMatchPhase::Live) {
+		const TCHAR* PhaseName = CachedPhase == ENSMatchPhase::Warmup ? TEXT("WARMUP") : TEXT("MATCH OVER");
+		AddTextItem(FString::Printf(TEXT("%s %d"), PhaseName, CachedRemainingSeconds), FColor::Yellow, Center.X, 50.0f, true);
+	}
+}
+
+void ANSHUD::AddTextItem(const FString& String, const FLinearColor& Color, float X, float Y, bool bCenterX)
+{
+	UFont* Font = GEngine->GetMediumFont();
+	if (bCenterX) {
+		float XL = 0.0f;
+		float YL = 0.0f;
+		Canvas->StrLen(Font, String, XL, YL);
+		X -= XL * 0.5f;
 	}
+	TextItems.Emplace(FVector2D(X, Y), FText::FromString(String), Font, Color);
 }
@@ -4,8 +4,16 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/HUD.h"
+#include "CanvasItem.h"
+#include "NSGameState.h"
 #include "NSHUD.generated.h"
 
+/**
+ * 글자는 표시할 값이 바뀌었을 때만 다시 만든다.
+ * 내 플레이어 상태와 스코어보드의 리비전, 매치 단계, 남은 초, 화면 크기가 같으면 지난 프레임의 텍스트 아이템을 그대로 그린다.
+ * 위치는 다시 만들 때 한 번만 재서 저장하므로 평소 프레임에는 힙 할당이 없다(NS.HUD.NoAllocs 테스트가 확인한다).
+ * 글자 아이템은 모두 같은 글꼴이라 캔버스가 한 배치로 묶는다. 4.19 캔버스에는 위치와 색이 다른 글자들을 아이템 하나로 넘기는 방법이 없다.
+ */
 UCLASS()
 class ANSHUD : public AHUD
 {
@@ -17,9 +25,49 @@ public:
 	/** Primary draw call for the HUD */
 	virtual void DrawHUD() override;
 
+#if !UE_BUILD_SHIPPING
+	/** 지난 DrawHUD에서 HUD 코드가 한 할당 수. 글자를 다시 만들지 않은 프레임은 0이어야 한다 */
+	int32 GetLastHUDAllocs() const { return LastHUDAllocs; }
+
+	/** 지난 DrawHUD의 DrawItem 호출 중 캔버스가 한 할당 수. 배치 저장소는 엔진이 프레임마다 새로 만드는 FCanvas 것이다 */
+	int32 GetLastCanvasAllocs() const { return LastCanvasAllocs; }
+#endif
+
 private:
+	/** 값이 바뀌었으면 텍스트 아이템을 다시 만든다 */
+	void UpdateTextItems(const FVector2D& Center);
+	void RebuildTextItems(const FVector2D& Center);
+
+	/** 글자 하나를 재서 아이템으로 추가한다. bCenterX면 X를 가운데로 맞춘다 */
+	void AddTextItem(const FString& String, const FLinearColor& Color, float X, float Y, bool bCenterX = false);
+
 	/** Crosshair asset pointer */
 	class UTexture2D* CrosshairTex;
 
-};
+	UPROPERTY(Transient)
+	class ANSGameState* CachedGameState;
+
+	UPROPERTY(Transient)
+	class ANSPlayerState* CachedPlayerState;
 
+	UPROPERTY(Transient)
+	class APawn* CachedPawn;
+
+	UPROPERTY(Transient)
+	class ANSCharacter* CachedCharacter;
+
+	/** 지난번에 글자를 만들 때 쓴 값들 */
+	ENSMatchPhase CachedPhase;
+	uint32 CachedScoreboardRevision;
+	uint32 CachedStatsRevision;
+	int32 CachedRemainingSeconds;
+	FVector2D CachedClipSize;
+	bool bTextDirty;
+
+	TArray<FCanvasTextItem> TextItems;
+
+#if !UE_BUILD_SHIPPING
+	int32 LastHUDAllocs;
+	int32 LastCanvasAllocs;
+#endif
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSHUD.h"
+#include "NSGameState.h"
+#include "NSPlayerState.h"
+#include "NSAllocCounter.h"
+#include "NS.h"
+#include "Engine/Canvas.h"
+#include "Engine/World.h"
+#include "CanvasTypes.h"
+#include "UnrealClient.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** 테스트 캔버스가 들고 있을 크기만 알려 준다. 플러시하지 않으니 렌더링에는 쓰이지 않는다 */
+	class FNSTestRenderTarget : public FRenderTarget
+	{
+	public:
+		virtual FIntPoint GetSizeXY() const override { return FIntPoint(1280, 720); }
+	};
+
+	/** 엔진이 뷰포트를 그릴 때처럼 프레임마다 새 FCanvas를 붙여 DrawHUD를 부른다 */
+	void DrawFrame(ANSHUD* HUD, UCanvas* Canvas, FRenderTarget& RenderTarget)
+	{
+		FCanvas CanvasObject(&RenderTarget, nullptr, HUD->GetWorld(), GMaxRHIFeatureLevel);
+		Canvas->Canvas = &CanvasObject;
+		HUD->Canvas = Canvas;
+		HUD->DrawHUD();
+		HUD->Canvas = nullptr;
+		Canvas->Canvas = nullptr;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSHUDNoAllocsTest, "NS.HUD.NoAllocs", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNSHUDNoAllocsTest::RunTest(const FString& Parameters)
+{
+	if (!TestTrue(TEXT("Allocation counter is installed"), FNSAllocCounter::IsInstalled())) {
+		return false;
+	}
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	ANSGameState* GameState = World->SpawnActor<ANSGameState>();
+	World->SetGameState(GameState);
+	GameState->MatchPhase = ENSMatchPhase::Lobby;
+
+	//로비 명단을 채운다. 플레이어 상태는 생길 때 게임 상태의 스코어보드에 들어간다
+	TArray<ANSPlayerState*> PlayerStates;
+	for (int32 i = 0; i < 8; i++) {
+		ANSPlayerState* PlayerState = World->SpawnActor<ANSPlayerState>();
+		PlayerState->SetPlayerName(FString::Printf(TEXT("Player%d"), i));
+		PlayerState->SetTeam(i % 2 ? ETeam::RED_TEAM : ETeam::BLUE_TEAM);
+		PlayerStates.Add(PlayerState);
+	}
+
+	ANSHUD* HUD = World->SpawnActor<ANSHUD>();
+	UCanvas* Canvas = NewObject<UCanvas>(GetTransientPackage());
+	Canvas->SizeX = 1280;
+	Canvas->SizeY = 720;
+	Canvas->ClipX = 1280.0f;
+	Canvas->ClipY = 720.0f;
+	FNSTestRenderTarget RenderTarget;
+
+	//처음 프레임은 글자를 만드니 할당이 있다
+	DrawFrame(HUD, Canvas, RenderTarget);
+	TestTrue(TEXT("First frame builds the text and allocates"), HUD->GetLastHUDAllocs() > 0);
+
+	const int32 NumFrames = 120;
+	int32 HUDAllocs = 0;
+	int32 CanvasAllocs = 0;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+		DrawFrame(HUD, Canvas, RenderTarget);
+		HUDAllocs += HUD->GetLastHUDAllocs();
+		CanvasAllocs += HUD->GetLastCanvasAllocs();
+	}
+	TestEqual(TEXT("HUD allocations over unchanged frames"), HUDAllocs, 0);
+
+	//명단이 바뀐 프레임에만 다시 만들고 그다음부터는 다시 0이다
+	PlayerStates[3]->AddScore(10.0f);
+	DrawFrame(HUD, Canvas, RenderTarget);
+	TestTrue(TEXT("Scoreboard change rebuilds the text"), HUD->GetLastHUDAllocs() > 0);
+	DrawFrame(HUD, Canvas, RenderTarget);
+	TestEqual(TEXT("HUD allocations after the rebuild"), HUD->GetLastHUDAllocs(), 0);
+
+	//캔버스 배치 저장소는 엔진이 프레임마다 새로 만드는 FCanvas의 것이라 값만 남긴다
+	AddInfo(FString::Printf(TEXT("Canvas DrawItem allocations: %.1f per frame"), (float)CanvasAllocs / NumFrames));
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
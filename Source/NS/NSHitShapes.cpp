@@ -0,0 +1,363 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSHitShapes.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hit Shape Update"), STAT_NSHitShapeUpdate, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Hit Shape Trace"), STAT_NSHitShapeTrace, STATGROUP_NS);
+
+namespace
+{
+	/** 기본 마네킹 기준. 머리는 구, 몸통 2개, 팔다리 8개 */
+	const FNSHitShapeDef DefaultDefs[] =
+	{
+		{ TEXT("head"), TEXT("head"), 13.0f, ENSHitZone::Head },
+		{ TEXT("pelvis"), TEXT("spine_03"), 20.0f, ENSHitZone::Body },
+		{ TEXT("spine_03"), TEXT("neck_01"), 16.0f, ENSHitZone::Body },
+		{ TEXT("upperarm_l"), TEXT("lowerarm_l"), 7.0f, ENSHitZone::Limb },
+		{ TEXT("lowerarm_l"), TEXT("hand_l"), 6.0f, ENSHitZone::Limb },
+		{ TEXT("upperarm_r"), TEXT("lowerarm_r"), 7.0f, ENSHitZone::Limb },
+		{ TEXT("lowerarm_r"), TEXT("hand_r"), 6.0f, ENSHitZone::Limb },
+		{ TEXT("thigh_l"), TEXT("calf_l"), 10.0f, ENSHitZone::Limb },
+		{ TEXT("calf_l"), TEXT("foot_l"), 8.0f, ENSHitZone::Limb },
+		{ TEXT("thigh_r"), TEXT("calf_r"), 10.0f, ENSHitZone::Limb },
+		{ TEXT("calf_r"), TEXT("foot_r"), 8.0f, ENSHitZone::Limb },
+	};
+	static_assert(ARRAY_COUNT(DefaultDefs) <= FNSHitShapeSet::MaxShapes, "Too many default hit shapes");
+
+	const float MissDistance = BIG_NUMBER;
+
+	FORCEINLINE VectorRegister Dot3(const VectorRegister& AX, const VectorRegister& AY, const VectorRegister& AZ, const VectorRegister& BX, const VectorRegister& BY, const VectorRegister& BZ)
+	{
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+
+	/** 음수가 아닌 값의 제곱근. x * rsqrt(x)라서 0에서도 0이 나오게 아래를 막는다 */
+	FORCEINLINE VectorRegister SafeSqrt(const VectorRegister& X)
+	{
+		return VectorMultiply(X, VectorReciprocalSqrtAccurate(VectorMax(X, VectorSetFloat1(SMALL_NUMBER))));
+	}
+}
+
+FNSHitShapeSet::FNSHitShapeSet()
+{
+	Reset();
+}
+
+const FNSHitShapeDef* FNSHitShapeSet::GetDefaultDefs(int32& OutNum)
+{
+	OutNum = ARRAY_COUNT(DefaultDefs);
+	return DefaultDefs;
+}
+
+void FNSHitShapeSet::Reset()
+{
+	//SIMD로 읽는 빈 레인도 NaN이 없도록 0으로 채운다
+	FMemory::Memzero(AX, sizeof(AX));
+	FMemory::Memzero(AY, sizeof(AY));
+	FMemory::Memzero(AZ, sizeof(AZ));
+	FMemory::Memzero(BAX, sizeof(BAX));
+	FMemory::Memzero(BAY, sizeof(BAY));
+	FMemory::Memzero(BAZ, sizeof(BAZ));
+	FMemory::Memzero(BABA, sizeof(BABA));
+	FMemory::Memzero(RadiusSquared, sizeof(RadiusSquared));
+	Count = 0;
+	BoundsCenter = FVector::ZeroVector;
+	BoundsRadius = 0.0f;
+}
+
+void FNSHitShapeSet::Add(const FVector& A, const FVector& B, float Radius, ENSHitZone Zone)
+{
+	if (Count >= MaxShapes) {
+		return;
+	}
+
+	const FVector BA = B - A;
+	AX[Count] = A.X;
+	AY[Count] = A.Y;
+	AZ[Count] = A.Z;
+	BAX[Count] = BA.X;
+	BAY[Count] = BA.Y;
+	BAZ[Count] = BA.Z;
+	BABA[Count] = BA.SizeSquared();
+	RadiusSquared[Count] = Radius * Radius;
+	Zones[Count] = Zone;
+	Count++;
+
+	//끝점을 반지름만큼 키운 상자로 경계 구를 다시 잡는다
+	FBox Bounds(ForceInit);
+	for (int32 i = 0; i < Count; i++) {
+		const FVector ShapeA(AX[i], AY[i], AZ[i]);
+		const FVector ShapeB = ShapeA + FVector(BAX[i], BAY[i], BAZ[i]);
+		const float ShapeRadius = FMath::Sqrt(RadiusSquared[i]);
+		Bounds += FBox(ShapeA.ComponentMin(ShapeB) - FVector(ShapeRadius), ShapeA.ComponentMax(ShapeB) + FVector(ShapeRadius));
+	}
+	BoundsCenter = Bounds.GetCenter();
+	BoundsRadius = Bounds.GetExtent().Size();
+}
+
+void FNSHitShapeSet::Update(const USkeletalMeshComponent* Mesh, const FTransform& ActorToWorld)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSHitShapeUpdate);
+
+	//FName 조회는 처음 한 번만 한다
+	static FName BoneNames[ARRAY_COUNT(DefaultDefs)][2];
+	static bool bNamesInitialized = false;
+	if (!bNamesInitialized) {
+		for (int32 i = 0; i < ARRAY_COUNT(DefaultDefs); i++) {
+			BoneNames[i][0] = FName(DefaultDefs[i].BoneA);
+			BoneNames[i][1] = FName(DefaultDefs[i].BoneB);
+		}
+		bNamesInitialized = true;
+	}
+
+	Reset();
+	if (Mesh == nullptr || Mesh->SkeletalMesh == nullptr) {
+		return;
+	}
+
+	for (int32 i = 0; i < ARRAY_COUNT(DefaultDefs); i++) {
+		const int32 BoneA = Mesh->GetBoneIndex(BoneNames[i][0]);
+		const int32 BoneB = Mesh->GetBoneIndex(BoneNames[i][1]);
+		if (BoneA == INDEX_NONE || BoneB == INDEX_NONE) {
+			continue;
+		}
+		const FVector A = ActorToWorld.InverseTransformPosition(Mesh->GetBoneTransform(BoneA).GetLocation());
+		const FVector B = ActorToWorld.InverseTransformPosition(Mesh->GetBoneTransform(BoneB).GetLocation());
+		Add(A, B, DefaultDefs[i].Radius, DefaultDefs[i].Zone);
+	}
+}
+
+bool FNSHitShapeSet::Trace(const FVector& Origin, const FVector& Dir, float MaxDistance, float& OutDistance, ENSHitZone& OutZone) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSHitShapeTrace);
+
+	const VectorRegister OX = VectorSetFloat1(Origin.X);
+	const VectorRegister OY = VectorSetFloat1(Origin.Y);
+	const VectorRegister OZ = VectorSetFloat1(Origin.Z);
+	const VectorRegister DX = VectorSetFloat1(Dir.X);
+	const VectorRegister DY = VectorSetFloat1(Dir.Y);
+	const VectorRegister DZ = VectorSetFloat1(Dir.Z);
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister Epsilon = VectorSetFloat1(KINDA_SMALL_NUMBER);
+	const VectorRegister Miss = VectorSetFloat1(MissDistance);
+
+	MS_ALIGN(16) float HitDistances[MaxShapes] GCC_ALIGN(16);
+
+	//캡슐 4개씩 레이-캡슐 교차를 분기 없이 계산한다
+	for (int32 i = 0; i < Count; i += 4) {
+		const VectorRegister BAx = VectorLoadAligned(BAX + i);
+		const VectorRegister BAy = VectorLoadAligned(BAY + i);
+		const VectorRegister BAz = VectorLoadAligned(BAZ + i);
+		const VectorRegister BABAv = VectorLoadAligned(BABA + i);
+		const VectorRegister R2 = VectorLoadAligned(RadiusSquared + i);
+
+		const VectorRegister OAx = VectorSubtract(OX, VectorLoadAligned(AX + i));
+		const VectorRegister OAy = VectorSubtract(OY, VectorLoadAligned(AY + i));
+		const VectorRegister OAz = VectorSubtract(OZ, VectorLoadAligned(AZ + i));
+
+		const VectorRegister BARD = Dot3(BAx, BAy, BAz, DX, DY, DZ);
+		const VectorRegister BAOA = Dot3(BAx, BAy, BAz, OAx, OAy, OAz);
+		const VectorRegister RDOA = Dot3(DX, DY, DZ, OAx, OAy, OAz);
+		const VectorRegister OAOA = Dot3(OAx, OAy, OAz, OAx, OAy, OAz);
+
+		//무한 원기둥과의 교차. 여기서 빗나가면 캡슐도 빗나간다
+		const VectorRegister QA = VectorSubtract(BABAv, VectorMultiply(BARD, BARD));
+		const VectorRegister QB = VectorSubtract(VectorMultiply(BABAv, RDOA), VectorMultiply(BAOA, BARD));
+		const VectorRegister QC = VectorSubtract(VectorSubtract(VectorMultiply(BABAv, OAOA), VectorMultiply(BAOA, BAOA)), VectorMultiply(R2, BABAv));
+		const VectorRegister H = VectorSubtract(VectorMultiply(QB, QB), VectorMultiply(QA, QC));
+		const VectorRegister bCylinder = VectorCompareGE(H, Zero);
+
+		const VectorRegister bSideValid = VectorCompareGT(QA, Epsilon);
+		const VectorRegister TSide = VectorMultiply(VectorNegate(VectorAdd(QB, SafeSqrt(VectorMax(H, Zero)))), VectorReciprocalAccurate(VectorMax(QA, Epsilon)));
+		//축과 평행한 레이(구 포함)는 옆면이 없고 진행 방향에서 먼저 만나는 반구만 본다
+		const VectorRegister YParallel = VectorSelect(VectorCompareGT(BARD, Zero), VectorSetFloat1(-1.0f), VectorAdd(BABAv, VectorSetFloat1(1.0f)));
+		const VectorRegister Y = VectorSelect(bSideValid, VectorMultiplyAdd(TSide, BARD, BAOA), YParallel);
+
+		const VectorRegister bOnSide = VectorBitwiseAnd(VectorCompareGT(Y, Zero), VectorCompareGT(BABAv, Y));
+		const VectorRegister bSide = VectorBitwiseAnd(VectorBitwiseAnd(bCylinder, bSideValid), VectorBitwiseAnd(bOnSide, VectorCompareGE(TSide, Zero)));
+
+		//옆면 범위를 벗어났으면 가까운 쪽 반구. O - B = OA - BA
+		const VectorRegister bCapA = VectorCompareGE(Zero, Y);
+		const VectorRegister OCx = VectorSelect(bCapA, OAx, VectorSubtract(OAx, BAx));
+		const VectorRegister OCy = VectorSelect(bCapA, OAy, VectorSubtract(OAy, BAy));
+		const VectorRegister OCz = VectorSelect(bCapA, OAz, VectorSubtract(OAz, BAz));
+		const VectorRegister CapB = Dot3(DX, DY, DZ, OCx, OCy, OCz);
+		const VectorRegister CapC = VectorSubtract(Dot3(OCx, OCy, OCz, OCx, OCy, OCz), R2);
+		const VectorRegister CapH = VectorSubtract(VectorMultiply(CapB, CapB), CapC);
+		const VectorRegister TCap = VectorNegate(VectorAdd(CapB, SafeSqrt(VectorMax(CapH, Zero))));
+		const VectorRegister bCap = VectorBitwiseAnd(VectorBitwiseAnd(bCylinder, VectorCompareGE(CapH, Zero)), VectorBitwiseAnd(VectorCompareGE(TCap, Zero), VectorBitwiseOr(bCapA, VectorCompareGE(Y, BABAv))));
+
+		const VectorRegister T = VectorSelect(bSide, TSide, VectorSelect(bCap, TCap, Miss));
+		VectorStoreAligned(T, HitDistances + i);
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	OutDistance = MaxDistance;
+	for (int32 i = 0; i < Count; i++) {
+		if (HitDistances[i] < OutDistance) {
+			OutDistance = HitDistances[i];
+			BestIndex = i;
+		}
+	}
+	if (BestIndex == INDEX_NONE) {
+		return false;
+	}
+	OutZone = Zones[BestIndex];
+	return true;
+}
+
+bool FNSHitShapeSet::TraceScalar(const FVector& Origin, const FVector& Dir, float MaxDistance, float& OutDistance, ENSHitZone& OutZone) const
+{
+	int32 BestIndex = INDEX_NONE;
+	OutDistance = MaxDistance;
+	for (int32 i = 0; i < Count; i++) {
+		const FVector BA(BAX[i], BAY[i], BAZ[i]);
+		const FVector OA = Origin - FVector(AX[i], AY[i], AZ[i]);
+		const float BARD = FVector::DotProduct(BA, Dir);
+		const float BAOA = FVector::DotProduct(BA, OA);
+		const float RDOA = FVector::DotProduct(Dir, OA);
+		const float OAOA = FVector::DotProduct(OA, OA);
+
+		const float QA = BABA[i] - BARD * BARD;
+		const float QB = BABA[i] * RDOA - BAOA * BARD;
+		const float QC = BABA[i] * OAOA - BAOA * BAOA - RadiusSquared[i] * BABA[i];
+		const float H = QB * QB - QA * QC;
+		if (H < 0.0f) {
+			continue;
+		}
+
+		float T = MissDistance;
+		float Y = BARD > 0.0f ? -1.0f : BABA[i] + 1.0f;
+		if (QA > KINDA_SMALL_NUMBER) {
+			T = (-QB - FMath::Sqrt(H)) / QA;
+			Y = BAOA + T * BARD;
+		}
+		if (!(QA > KINDA_SMALL_NUMBER && Y > 0.0f && Y < BABA[i] && T >= 0.0f)) {
+			T = MissDistance;
+			if (!(Y > 0.0f && Y < BABA[i])) {
+				const FVector OC = Y <= 0.0f ? OA : OA - BA;
+				const float CapB = FVector::DotProduct(Dir, OC);
+				const float CapH = CapB * CapB - (OC.SizeSquared() - RadiusSquared[i]);
+				if (CapH >= 0.0f) {
+					const float TCap = -CapB - FMath::Sqrt(CapH);
+					T = TCap >= 0.0f ? TCap : MissDistance;
+				}
+			}
+		}
+
+		if (T < OutDistance) {
+			OutDistance = T;
+			BestIndex = i;
+		}
+	}
+	if (BestIndex == INDEX_NONE) {
+		return false;
+	}
+	OutZone = Zones[BestIndex];
+	return true;
+}
+
+#if !UE_BUILD_SHIPPING
+/** ns.HitShapeBench [레이 수] : 히트 캡슐 SIMD 검사, 스칼라 검사, 피직스 에셋 바디 트레이스를 같은 레이로 비교한다 */
+static FAutoConsoleCommandWithWorldAndArgs NSHitShapeBenchCommand(
+	TEXT("ns.HitShapeBench"),
+	TEXT("Times the SIMD hit shape kernel against the scalar version and the per-body physics asset trace. Usage: ns.HitShapeBench [NumRays]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 NumRays = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+
+		//월드에 포즈가 있는 캐릭터가 있으면 그 메시를 쓰고, 없으면 임의의 캡슐로 잰다
+		ANSCharacter* Target = nullptr;
+		if (World) {
+			for (TActorIterator<ANSCharacter> Iter(World); Iter; ++Iter) {
+				if ((*Iter)->GetMesh()->SkeletalMesh != nullptr) {
+					Target = *Iter;
+					break;
+				}
+			}
+		}
+
+		FRandomStream Random(1234);
+		FNSHitShapeSet Shapes;
+		FTransform ActorToWorld = FTransform::Identity;
+		if (Target) {
+			ActorToWorld = Target->GetCapsuleComponent()->GetComponentTransform();
+			Shapes.Update(Target->GetMesh(), ActorToWorld);
+		}
+		if (Shapes.Num() == 0) {
+			for (int32 i = 0; i < 11; i++) {
+				const FVector A(Random.FRandRange(-30.0f, 30.0f), Random.FRandRange(-30.0f, 30.0f), Random.FRandRange(-90.0f, 90.0f));
+				Shapes.Add(A, A + Random.GetUnitVector() * Random.FRandRange(10.0f, 40.0f), Random.FRandRange(6.0f, 20.0f), ENSHitZone::Body);
+			}
+		}
+
+		//경계 구 근처를 향해 사방에서 쏘는 레이
+		TArray<FVector> Origins;
+		TArray<FVector> Dirs;
+		Origins.SetNumUninitialized(NumRays);
+		Dirs.SetNumUninitialized(NumRays);
+		for (int32 i = 0; i < NumRays; i++) {
+			Origins[i] = Shapes.GetBoundsCenter() + Random.GetUnitVector() * 500.0f;
+			const FVector Aim = Shapes.GetBoundsCenter() + Random.GetUnitVector() * Shapes.GetBoundsRadius() * Random.FRand();
+			Dirs[i] = (Aim - Origins[i]).GetSafeNormal();
+		}
+
+		float Distance;
+		ENSHitZone Zone;
+		int32 SimdHits = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRays; i++) {
+			SimdHits += Shapes.Trace(Origins[i], Dirs[i], 1000.0f, Distance, Zone) ? 1 : 0;
+		}
+		const double SimdTime = FPlatformTime::Seconds() - StartTime;
+
+		int32 ScalarHits = 0;
+		int32 Mismatches = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumRays; i++) {
+			ScalarHits += Shapes.TraceScalar(Origins[i], Dirs[i], 1000.0f, Distance, Zone) ? 1 : 0;
+		}
+		const double ScalarTime = FPlatformTime::Seconds() - StartTime;
+
+		for (int32 i = 0; i < NumRays; i++) {
+			float SimdDistance, ScalarDistance;
+			ENSHitZone SimdZone, ScalarZone;
+			const bool bSimdHit = Shapes.Trace(Origins[i], Dirs[i], 1000.0f, SimdDistance, SimdZone);
+			const bool bScalarHit = Shapes.TraceScalar(Origins[i], Dirs[i], 1000.0f, ScalarDistance, ScalarZone);
+			if (bSimdHit != bScalarHit || (bSimdHit && FMath::Abs(SimdDistance - ScalarDistance) > 0.1f)) {
+				Mismatches++;
+			}
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("ns.HitShapeBench: %d rays, %d shapes%s"), NumRays, Shapes.Num(), Target ? TEXT(" from character pose") : TEXT(" (synthetic)"));
+		UE_LOG(LogTemp, Display, TEXT("  SIMD   : %.1f ns/ray, %d hits"), SimdTime * 1e9 / NumRays, SimdHits);
+		UE_LOG(LogTemp, Display, TEXT("  scalar : %.1f ns/ray, %d hits, %d mismatches"), ScalarTime * 1e9 / NumRays, ScalarHits, Mismatches);
+
+		//피직스 에셋 바디마다 트레이스하는 기존 방식. 바디가 없으면(서버에서 물리 상태가 없으면) 건너뛴다
+		if (Target && Target->GetMesh()->Bodies.Num() > 0) {
+			USkeletalMeshComponent* Mesh = Target->GetMesh();
+			FCollisionQueryParams Params(SCENE_QUERY_STAT(NSHitShapeBench), false);
+			int32 PhysicsHits = 0;
+			FHitResult Hit;
+			StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumRays; i++) {
+				const FVector WorldOrigin = ActorToWorld.TransformPosition(Origins[i]);
+				const FVector WorldEnd = WorldOrigin + ActorToWorld.TransformVectorNoScale(Dirs[i]) * 1000.0f;
+				PhysicsHits += Mesh->LineTraceComponent(Hit, WorldOrigin, WorldEnd, Params) ? 1 : 0;
+			}
+			const double PhysicsTime = FPlatformTime::Seconds() - StartTime;
+			UE_LOG(LogTemp, Display, TEXT("  physics: %.1f ns/ray, %d hits, %d bodies"), PhysicsTime * 1e9 / NumRays, PhysicsHits, Mesh->Bodies.Num());
+		}
+		else {
+			UE_LOG(LogTemp, Display, TEXT("  physics: skipped (no character with physics bodies)"));
+		}
+	})
+);
+#endif
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/** 히트 부위. 부위마다 피해 배율이 다르다 */
+enum class ENSHitZone : uint8
+{
+	Body,
+	Head,
+	Limb
+};
+
+/** 뼈 두 개 사이의 캡슐 하나 */
+struct FNSHitShapeDef
+{
+	const TCHAR* BoneA;
+	const TCHAR* BoneB;
+	float Radius;
+	ENSHitZone Zone;
+};
+
+/**
+ * 캐릭터 하나의 부위별 히트 캡슐.
+ * 피직스 에셋 대신 애니메이션 포즈의 뼈 위치로 캡슐 몇 개를 만들어 액터 로컬 공간에 SoA로 저장한다.
+ * 로컬 공간이라 랙 보상은 되감은 캡슐 변환만 적용하면 되고, 포즈는 낮은 빈도로만 갱신한다.
+ * 레이 검사는 캡슐 4개씩 SIMD로 한다.
+ */
+class NS_API FNSHitShapeSet
+{
+public:
+	/** SIMD 폭의 배수 */
+	enum { MaxShapes = 12 };
+
+	FNSHitShapeSet();
+
+	/** 기본 마네킹 뼈 기준 캡슐 정의 */
+	static const FNSHitShapeDef* GetDefaultDefs(int32& OutNum);
+
+	/**
+	 * 메시의 현재 포즈로 캡슐을 다시 만든다. 없는 뼈를 쓰는 캡슐은 건너뛴다.
+	 * @param ActorToWorld	캡슐을 저장할 로컬 공간(루트 캡슐 변환)
+	 */
+	void Update(const USkeletalMeshComponent* Mesh, const FTransform& ActorToWorld);
+
+	/** 캡슐을 직접 넣는다. 로컬 공간 좌표 */
+	void Reset();
+	void Add(const FVector& A, const FVector& B, float Radius, ENSHitZone Zone);
+
+	/**
+	 * 로컬 공간의 단위 방향 레이를 검사한다.
+	 * @return MaxDistance 안에 가장 가까운 히트가 있으면 true
+	 */
+	bool Trace(const FVector& Origin, const FVector& Dir, float MaxDistance, float& OutDistance, ENSHitZone& OutZone) const;
+
+	/** 같은 검사를 캡슐 하나씩 스칼라로 한다. 벤치마크와 검증용 */
+	bool TraceScalar(const FVector& Origin, const FVector& Dir, float MaxDistance, float& OutDistance, ENSHitZone& OutZone) const;
+
+	int32 Num() const { return Count; }
+
+	/** 모든 캡슐을 감싸는 구(로컬 공간). 넓은 단계 검사에 쓴다 */
+	const FVector& GetBoundsCenter() const { return BoundsCenter; }
+	float GetBoundsRadius() const { return BoundsRadius; }
+
+private:
+	//끝점 A, 축 BA = B - A, |BA|^2, 반지름^2
+	MS_ALIGN(16) float AX[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float AY[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float AZ[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float BAX[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float BAY[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float BAZ[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float BABA[MaxShapes] GCC_ALIGN(16);
+	MS_ALIGN(16) float RadiusSquared[MaxShapes] GCC_ALIGN(16);
+	ENSHitZone Zones[MaxShapes];
+
+	int32 Count;
+	FVector BoundsCenter;
+	float BoundsRadius;
+};
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSLagCompensation.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "NSPlayerState.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Trace"), STAT_NSLagCompensationTrace, STATGROUP_NS);
+
+namespace
+{
+	/** 단위 방향 레이와 구의 교차. 레이 시작점 앞쪽의 첫 교차 거리를 돌려준다 */
+	bool RaySphere(const FVector& Origin, const FVector& Dir, const FVector& Center, float Radius, float& OutT)
+	{
+		const FVector OC = Origin - Center;
+		const float B = FVector::DotProduct(Dir, OC);
+		const float C = OC.SizeSquared() - Radius * Radius;
+		const float H = B * B - C;
+		if (H < 0.0f) {
+			return false;
+		}
+		OutT = -B - FMath::Sqrt(H);
+		return OutT >= 0.0f;
+	}
+
+	/** 단위 방향 레이와 캡슐(선분 A-B, 반지름 Radius)의 교차 */
+	bool RayCapsule(const FVector& Origin, const FVector& Dir, const FVector& A, const FVector& B, float Radius, float& OutT)
+	{
+		const FVector BA = B - A;
+		const FVector OA = Origin - A;
+		const float BABA = FVector::DotProduct(BA, BA);
+		const float BARD = FVector::DotProduct(BA, Dir);
+		const float BAOA = FVector::DotProduct(BA, OA);
+		const float RDOA = FVector::DotProduct(Dir, OA);
+		const float OAOA = FVector::DotProduct(OA, OA);
+
+		const float QA = BABA - BARD * BARD;
+		if (QA > KINDA_SMALL_NUMBER) {
+			//원기둥 옆면
+			const float QB = BABA * RDOA - BAOA * BARD;
+			const float QC = BABA * OAOA - BAOA * BAOA - Radius * Radius * BABA;
+			const float H = QB * QB - QA * QC;
+			if (H < 0.0f) {
+				return false;
+			}
+			const float T = (-QB - FMath::Sqrt(H)) / QA;
+			const float Y = BAOA + T * BARD;
+			if (Y > 0.0f && Y < BABA && T >= 0.0f) {
+				OutT = T;
+				return true;
+			}
+		}
+
+		//양 끝의 반구. 축과 평행한 레이와 옆면 교차가 시작점 뒤에 있는 레이는 여기서 걸린다
+		float TA, TB;
+		const bool bHitA = RaySphere(Origin, Dir, A, Radius, TA);
+		const bool bHitB = RaySphere(Origin, Dir, B, Radius, TB);
+		if (bHitA && bHitB) {
+			OutT = FMath::Min(TA, TB);
+			return true;
+		}
+		if (bHitA || bHitB) {
+			OutT = bHitA ? TA : TB;
+			return true;
+		}
+		return false;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FNSPoseHistory
+
+FNSPoseHistory::FNSPoseHistory()
+	: Head(0)
+	, Count(0)
+{
+}
+
+void FNSPoseHistory::Reset()
+{
+	Head = 0;
+	Count = 0;
+}
+
+void FNSPoseHistory::Record(const FNSPoseSnapshot& Snapshot)
+{
+	Snapshots[Head] = Snapshot;
+	Head = (Head + 1) % Capacity;
+	Count = FMath::Min(Count + 1, (int32)Capacity);
+}
+
+bool FNSPoseHistory::Sample(float Time, FNSPoseSnapshot& OutPose) const
+{
+	if (Count == 0) {
+		return false;
+	}
+
+	const FNSPoseSnapshot& Oldest = Get(0);
+	const FNSPoseSnapshot& Newest = Get(Count - 1);
+	if (Time <= Oldest.Time) {
+		OutPose = Oldest;
+		return true;
+	}
+	if (Time >= Newest.Time) {
+		OutPose = Newest;
+		return true;
+	}
+
+	//Time보다 늦은 첫 기록을 이진 탐색
+	int32 Low = 1;
+	int32 High = Count - 1;
+	while (Low < High) {
+		const int32 Mid = (Low + High) / 2;
+		if (Get(Mid).Time < Time) {
+			Low = Mid + 1;
+		}
+		else {
+			High = Mid;
+		}
+	}
+
+	const FNSPoseSnapshot& Before = Get(Low - 1);
+	const FNSPoseSnapshot& After = Get(Low);
+	const float Span = After.Time - Before.Time;
+	const float Alpha = Span > SMALL_NUMBER ? (Time - Before.Time) / Span : 1.0f;
+
+	OutPose.Time = Time;
+	OutPose.Location = FMath::Lerp(Before.Location, After.Location, Alpha);
+	OutPose.Rotation = FQuat::Slerp(Before.Rotation, After.Rotation, Alpha);
+	OutPose.EyeLocation = FMath::Lerp(Before.EyeLocation, After.EyeLocation, Alpha);
+	OutPose.Radius = After.Radius;
+	OutPose.HalfHeight = After.HalfHeight;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FNSLagCompensation
+
+FNSLagCompensation::FNSLagCompensation()
+	: MaxRewindTime(0.25f)
+{
+	Characters.Reserve(64);
+}
+
+void FNSLagCompensation::Register(ANSCharacter* Character)
+{
+	Characters.AddUnique(Character);
+}
+
+void FNSLagCompensation::Unregister(ANSCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+float FNSLagCompensation::ClampRewindTime(float ClientTime, float ServerTime) const
+{
+	return FMath::Clamp(ClientTime, ServerTime - MaxRewindTime, ServerTime);
+}
+
+bool FNSLagCompensation::TraceRewound(const FVector& Start, const FVector& End, float Time, const ANSCharacter* IgnoreCharacter, FNSRewindHit& OutHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSLagCompensationTrace);
+
+	FVector Dir;
+	float MaxDistance;
+	(End - Start).ToDirectionAndLength(Dir, MaxDistance);
+
+	OutHit.Character = nullptr;
+	OutHit.Distance = MaxDistance;
+	OutHit.Zone = ENSHitZone::Body;
+
+	for (ANSCharacter* Character : Characters) {
+		if (Character == IgnoreCharacter || !IsTargetable(Character)) {
+			continue;
+		}
+
+		float HitDistance;
+		ENSHitZone Zone;
+		if (TraceTarget(Character->GetPoseHistory(), Character->GetHitShapes(), Start, Dir, Time, OutHit.Distance, HitDistance, Zone)) {
+			OutHit.Character = Character;
+			OutHit.Distance = HitDistance;
+			OutHit.Zone = Zone;
+		}
+	}
+
+	if (OutHit.Character == nullptr) {
+		return false;
+	}
+	OutHit.Location = Start + Dir * OutHit.Distance;
+	return true;
+}
+
+bool FNSLagCompensation::IsTargetable(ANSCharacter* Character)
+{
+	//죽는 중인 캐릭터는 리스폰까지 등록된 채로 남으므로 여기서 거른다. 체력은 사망 멀티캐스트보다 먼저 0이 된다
+	if (Character->IsDying()) {
+		return false;
+	}
+	const ANSPlayerState* thisPS = Character->GetNSPlayerState();
+	return thisPS == nullptr || thisPS->GetHealth() > 0;
+}
+
+bool FNSLagCompensation::TraceTarget(const FNSPoseHistory& History, const FNSHitShapeSet& HitShapes, const FVector& Start, const FVector& Dir, float Time, float MaxDistance, float& OutDistance, ENSHitZone& OutZone)
+{
+	FNSPoseSnapshot Pose;
+	if (!History.Sample(Time, Pose)) {
+		return false;
+	}
+
+	if (HitShapes.Num() > 0) {
+		//레이를 되감은 액터 로컬 공간으로 옮긴다. 회전만 있으므로 거리는 그대로다
+		const FVector LocalStart = Pose.Rotation.UnrotateVector(Start - Pose.Location);
+		const FVector LocalDir = Pose.Rotation.UnrotateVector(Dir);
+		float BoundsDistance;
+		if (!RaySphere(LocalStart, LocalDir, HitShapes.GetBoundsCenter(), HitShapes.GetBoundsRadius(), BoundsDistance)
+			&& FVector::DistSquared(LocalStart, HitShapes.GetBoundsCenter()) > FMath::Square(HitShapes.GetBoundsRadius())) {
+			return false;
+		}
+		return HitShapes.Trace(LocalStart, LocalDir, MaxDistance, OutDistance, OutZone);
+	}
+
+	const FVector Axis = Pose.Rotation.GetUpVector() * FMath::Max(Pose.HalfHeight - Pose.Radius, 0.0f);
+	if (RayCapsule(Start, Dir, Pose.Location - Axis, Pose.Location + Axis, Pose.Radius, OutDistance) && OutDistance < MaxDistance) {
+		OutZone = ENSHitZone::Body;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NSHitShapes.h"
+
+class ANSCharacter;
+
+/** 특정 시점의 캐릭터 히트박스(캡슐) 상태 */
+struct FNSPoseSnapshot
+{
+	float Time;
+	FVector Location;
+	FQuat Rotation;
+	float Radius;
+	float HalfHeight;
+
+	/** 1인칭 카메라 위치. 발사 원점 검증에 쓴다 */
+	FVector EyeLocation;
+};
+
+/**
+ * 서버에서 캐릭터마다 유지하는 포즈 기록.
+ * 고정 크기 링 버퍼라서 기록/조회 중에 메모리 할당이 없다.
+ */
+class NS_API FNSPoseHistory
+{
+public:
+	/** 60Hz 서버 기준 약 1초 분량 */
+	enum { Capacity = 64 };
+
+	FNSPoseHistory();
+
+	void Reset();
+	void Record(const FNSPoseSnapshot& Snapshot);
+
+	/** Time 시점의 포즈를 앞뒤 기록 사이에서 보간해 얻는다. 기록이 없으면 false */
+	bool Sample(float Time, FNSPoseSnapshot& OutPose) const;
+
+	int32 Num() const { return Count; }
+
+private:
+	/** 오래된 순서의 논리 인덱스로 기록을 얻는다 */
+	const FNSPoseSnapshot& Get(int32 Index) const
+	{
+		return Snapshots[(Head - Count + Index + Capacity) % Capacity];
+	}
+
+	FNSPoseSnapshot Snapshots[Capacity];
+	int32 Head;
+	int32 Count;
+};
+
+/** 되감은 히트박스에 대한 트레이스 결과 */
+struct FNSRewindHit
+{
+	ANSCharacter* Character;
+	FVector Location;
+	float Distance;
+
+	/** 맞은 부위. 히트 캡슐이 없는 캐릭터는 Body */
+	ENSHitZone Zone;
+};
+
+/**
+ * 랙 보상 히트 판정.
+ * 서버의 캐릭터 목록을 들고 있다가 클라이언트가 쏜 시점으로 히트박스를 되감아 레이를 검사한다.
+ * 액터를 실제로 옮기지 않고 기록된 캡슐에 대해 직접 교차 검사를 하므로 복원할 것도 없다.
+ * 부위별 히트 캡슐은 액터 로컬 공간에 있으므로 되감은 루트 변환으로 레이를 로컬로 옮겨 검사한다.
+ */
+class NS_API FNSLagCompensation
+{
+public:
+	FNSLagCompensation();
+
+	void Register(ANSCharacter* Character);
+	void Unregister(ANSCharacter* Character);
+
+	/**
+	 * Time 시점으로 되감은 히트박스들에 대해 Start~End 레이를 검사한다.
+	 * @param IgnoreCharacter	검사에서 제외할 캐릭터(보통 쏜 사람)
+	 * @return 가장 가까운 히트가 있으면 true
+	 */
+	bool TraceRewound(const FVector& Start, const FVector& End, float Time, const ANSCharacter* IgnoreCharacter, FNSRewindHit& OutHit) const;
+
+	/**
+	 * 캐릭터 하나의 기록을 Time 시점으로 되감아 단위 방향 레이를 검사한다. 액터 없이도 쓸 수 있어 자동화 테스트가 직접 부른다.
+	 * @param HitShapes	액터 로컬 공간의 부위별 캡슐. 비어 있으면 기록된 루트 캡슐로 검사한다
+	 * @return MaxDistance 안에서 맞으면 true
+	 */
+	static bool TraceTarget(const FNSPoseHistory& History, const FNSHitShapeSet& HitShapes, const FVector& Start, const FVector& Dir, float Time, float MaxDistance, float& OutDistance, ENSHitZone& OutZone);
+
+	/** 죽었거나 죽는 중인 캐릭터는 되감은 히트를 받지 않는다 */
+	static bool IsTargetable(ANSCharacter* Character);
+
+	/** 클라이언트 시간을 서버가 허용하는 되감기 범위로 자른다 */
+	float ClampRewindTime(float ClientTime, float ServerTime) const;
+
+	/** 등록된 캐릭터 목록 */
+	const TArray<ANSCharacter*>& GetCharacters() const { return Characters; }
+
+	/** 되감기를 허용하는 최대 시간(초) */
+	float MaxRewindTime;
+
+private:
+	TArray<ANSCharacter*> Characters;
+};
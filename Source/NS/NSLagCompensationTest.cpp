@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSLagCompensation.h"
+#include "NS.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** 테스트 경기장. 쏘는 사람이 가운데 있고 64명이 가운데를 보며 같은 방향으로 원을 따라 옆걸음한다 */
+	const int32 NumTargets = 64;
+	const float RingRadius = 2000.0f;
+	const float RunSpeed = 600.0f;
+	const float RecordRate = 60.0f;
+	const float HeadHeight = 70.0f;
+	const float BodyHeight = 20.0f;
+
+	/** 대상 하나의 Time 시점 루트 위치와 방향 */
+	void GetTargetPose(int32 Index, float Time, FVector& OutLocation, FQuat& OutRotation)
+	{
+		const float Angle = 2.0f * PI * Index / NumTargets + RunSpeed / RingRadius * Time;
+		OutLocation = FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * RingRadius;
+		OutRotation = FRotator(0.0f, FMath::RadiansToDegrees(Angle) + 180.0f, 0.0f).Quaternion();
+	}
+
+	/** 기본 마네킹과 비슷한 크기의 부위 캡슐(루트 캡슐 기준 로컬 공간) */
+	void BuildHitShapes(FNSHitShapeSet& Shapes)
+	{
+		Shapes.Reset();
+		Shapes.Add(FVector(0.0f, 0.0f, HeadHeight), FVector(0.0f, 0.0f, HeadHeight), 13.0f, ENSHitZone::Head);
+		Shapes.Add(FVector(0.0f, 0.0f, -5.0f), FVector(0.0f, 0.0f, 45.0f), 20.0f, ENSHitZone::Body);
+		Shapes.Add(FVector(0.0f, -25.0f, 40.0f), FVector(0.0f, -30.0f, -10.0f), 7.0f, ENSHitZone::Limb);
+		Shapes.Add(FVector(0.0f, 25.0f, 40.0f), FVector(0.0f, 30.0f, -10.0f), 7.0f, ENSHitZone::Limb);
+		Shapes.Add(FVector(0.0f, -10.0f, -15.0f), FVector(0.0f, -10.0f, -85.0f), 10.0f, ENSHitZone::Limb);
+		Shapes.Add(FVector(0.0f, 10.0f, -15.0f), FVector(0.0f, 10.0f, -85.0f), 10.0f, ENSHitZone::Limb);
+	}
+
+	/** 서버가 틱마다 기록하듯 1초 분량의 포즈를 채운다. 마지막 기록 시각을 돌려준다 */
+	float RecordTargets(TArray<FNSPoseHistory>& Histories)
+	{
+		Histories.SetNum(NumTargets);
+		const int32 NumFrames = FMath::Min((int32)RecordRate, (int32)FNSPoseHistory::Capacity);
+		float Time = 0.0f;
+		for (int32 Frame = 0; Frame < NumFrames; Frame++) {
+			Time = Frame / RecordRate;
+			for (int32 i = 0; i < NumTargets; i++) {
+				FNSPoseSnapshot Snapshot;
+				Snapshot.Time = Time;
+				GetTargetPose(i, Time, Snapshot.Location, Snapshot.Rotation);
+				Snapshot.Radius = 34.0f;
+				Snapshot.HalfHeight = 88.0f;
+				Snapshot.EyeLocation = Snapshot.Location + FVector(0.0f, 0.0f, 64.0f);
+				Histories[i].Record(Snapshot);
+			}
+		}
+		return Time;
+	}
+
+	/** TraceRewound와 같은 순서로 모든 대상을 검사한다 */
+	int32 TraceAll(const TArray<FNSPoseHistory>& Histories, const FNSHitShapeSet& Shapes, const FVector& Start, const FVector& End, float Time, ENSHitZone& OutZone)
+	{
+		FVector Dir;
+		float Distance;
+		(End - Start).ToDirectionAndLength(Dir, Distance);
+
+		int32 HitIndex = INDEX_NONE;
+		for (int32 i = 0; i < Histories.Num(); i++) {
+			float HitDistance;
+			ENSHitZone Zone;
+			if (FNSLagCompensation::TraceTarget(Histories[i], Shapes, Start, Dir, Time, Distance, HitDistance, Zone)) {
+				HitIndex = i;
+				Distance = HitDistance;
+				OutZone = Zone;
+			}
+		}
+		return HitIndex;
+	}
+
+	/** 녹화된 사격 하나. 클라이언트가 본 대상 위치를 겨눈 레이와 그때의 핑 */
+	struct FNSRecordedShot
+	{
+		int32 Target;
+		float Latency;
+		ENSHitZone AimZone;
+	};
+
+	const FNSRecordedShot RecordedShots[] =
+	{
+		{ 0, 0.050f, ENSHitZone::Head },
+		{ 7, 0.080f, ENSHitZone::Body },
+		{ 13, 0.100f, ENSHitZone::Head },
+		{ 21, 0.120f, ENSHitZone::Body },
+		{ 32, 0.150f, ENSHitZone::Head },
+		{ 40, 0.150f, ENSHitZone::Body },
+		{ 51, 0.200f, ENSHitZone::Head },
+		{ 63, 0.230f, ENSHitZone::Body },
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSLagCompensationReplayTest, "NS.LagCompensation.ReplayShots", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNSLagCompensationReplayTest::RunTest(const FString& Parameters)
+{
+	TArray<FNSPoseHistory> Histories;
+	const float ServerTime = RecordTargets(Histories);
+	FNSHitShapeSet Shapes;
+	BuildHitShapes(Shapes);
+
+	FNSLagCompensation LagCompensation;
+
+	for (const FNSRecordedShot& Shot : RecordedShots) {
+		const float ClientTime = LagCompensation.ClampRewindTime(ServerTime - Shot.Latency, ServerTime);
+
+		FVector Location;
+		FQuat Rotation;
+		GetTargetPose(Shot.Target, ClientTime, Location, Rotation);
+		const FVector Start(0.0f, 0.0f, Shot.AimZone == ENSHitZone::Head ? HeadHeight : BodyHeight);
+		const FVector End = Start + Location.GetSafeNormal() * (RingRadius + 500.0f);
+
+		//쏜 시점으로 되감으면 겨눈 대상의 겨눈 부위에 맞아야 한다
+		ENSHitZone Zone = ENSHitZone::Body;
+		const int32 Rewound = TraceAll(Histories, Shapes, Start, End, ClientTime, Zone);
+		TestEqual(FString::Printf(TEXT("Rewound shot at target %d (%.0f ms) hits it"), Shot.Target, Shot.Latency * 1000.0f), Rewound, Shot.Target);
+		TestTrue(FString::Printf(TEXT("Rewound shot at target %d hits the aimed zone"), Shot.Target), Zone == Shot.AimZone);
+
+		//되감지 않으면 대상이 이미 지나가서 빗나가야 한다. 핑이 짧으면 몸통에는 아직 걸릴 수 있으니 머리만 본다
+		if (Shot.AimZone == ENSHitZone::Head && Shot.Latency >= 0.1f) {
+			const int32 Current = TraceAll(Histories, Shapes, Start, End, ServerTime, Zone);
+			TestTrue(FString::Printf(TEXT("Unrewound head shot at target %d misses"), Shot.Target), Current != Shot.Target || Zone != ENSHitZone::Head);
+		}
+	}
+
+	//머리 위로 쏜 레이는 누구도 맞히지 않는다
+	ENSHitZone Zone;
+	TestEqual(TEXT("Shot over the heads misses"), TraceAll(Histories, Shapes, FVector(0.0f, 0.0f, 200.0f), FVector(RingRadius + 500.0f, 0.0f, 200.0f), ServerTime, Zone), (int32)INDEX_NONE);
+
+	//허용 범위보다 오래된 시각은 잘린다
+	TestEqual(TEXT("Old client time is clamped"), LagCompensation.ClampRewindTime(ServerTime - 1.0f, ServerTime), ServerTime - LagCompensation.MaxRewindTime);
+	TestEqual(TEXT("Future client time is clamped"), LagCompensation.ClampRewindTime(ServerTime + 1.0f, ServerTime), ServerTime);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSLagCompensationBenchTest, "NS.LagCompensation.Bench64", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FNSLagCompensationBenchTest::RunTest(const FString& Parameters)
+{
+	//목표: 64명 기준 한 발에 50us 미만
+	const double BudgetMicroseconds = 50.0;
+	const int32 NumShots = 20000;
+
+	TArray<FNSPoseHistory> Histories;
+	const float ServerTime = RecordTargets(Histories);
+	FNSHitShapeSet Shapes;
+	BuildHitShapes(Shapes);
+
+	//대상 근처를 겨눈 레이와 여러 핑. 타이머 밖에서 미리 만든다
+	FRandomStream Random(1234);
+	TArray<FVector> Ends;
+	TArray<float> Times;
+	Ends.SetNumUninitialized(NumShots);
+	Times.SetNumUninitialized(NumShots);
+	for (int32 i = 0; i < NumShots; i++) {
+		Times[i] = ServerTime - Random.FRandRange(0.0f, 0.25f);
+		FVector Location;
+		FQuat Rotation;
+		GetTargetPose(Random.RandHelper(NumTargets), Times[i], Location, Rotation);
+		const FVector Aim = Location + FVector(Random.FRandRange(-40.0f, 40.0f), Random.FRandRange(-40.0f, 40.0f), Random.FRandRange(-90.0f, 90.0f));
+		Ends[i] = Aim.GetSafeNormal() * (RingRadius + 500.0f);
+	}
+
+	int32 NumHits = 0;
+	ENSHitZone Zone;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumShots; i++) {
+		NumHits += TraceAll(Histories, Shapes, FVector::ZeroVector, Ends[i], Times[i], Zone) != INDEX_NONE ? 1 : 0;
+	}
+	const double PerShot = (FPlatformTime::Seconds() - StartTime) * 1e6 / NumShots;
+
+	AddInfo(FString::Printf(TEXT("Lag compensated trace: %.2f us/shot against %d targets (%d/%d shots hit, budget %.0f us)"), PerShot, NumTargets, NumHits, NumShots, BudgetMicroseconds));
+	if (PerShot > BudgetMicroseconds) {
+		//디버그 빌드나 바쁜 머신에서는 넘을 수 있으니 실패 대신 경고로 남긴다
+		AddWarning(FString::Printf(TEXT("Lag compensated trace is over budget: %.2f us/shot"), PerShot));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSLoadTestRecorder.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameStateBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "NSTickAudit.h"
+
+int32 ANSLoadTestRecorder::NumRPCs = 0;
+
+ANSLoadTestRecorder::ANSLoadTestRecorder()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+	bReplicates = false;
+
+	Window = 10.0f;
+	WindowStartTime = 0.0;
+	OutBytesPerSecondSum = 0;
+	InBytesPerSecondSum = 0;
+	NumConnectionSamples = 0;
+	NumGCs = 0;
+	MaxGCTime = 0.0;
+	GCStartTime = 0.0;
+}
+
+void ANSLoadTestRecorder::StartIfRequested(UWorld* World)
+{
+	FString Path;
+	if (World == nullptr || !FParse::Value(FCommandLine::Get(), TEXT("NSLoadTestCsv="), Path)) {
+		return;
+	}
+
+	ANSLoadTestRecorder* Recorder = World->SpawnActorDeferred<ANSLoadTestRecorder>(ANSLoadTestRecorder::StaticClass(), FTransform::Identity);
+	if (Recorder) {
+		Recorder->CsvPath = FPaths::ConvertRelativePathToFull(Path);
+		FParse::Value(FCommandLine::Get(), TEXT("NSLoadTestWindow="), Recorder->Window);
+		Recorder->FinishSpawning(FTransform::Identity);
+	}
+}
+
+void ANSLoadTestRecorder::BeginPlay()
+{
+	Super::BeginPlay();
+
+	TickTimes.Reserve(FMath::CeilToInt(Window * 120.0f));
+	WindowStartTime = FPlatformTime::Seconds();
+	NumRPCs = 0;
+
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &ANSLoadTestRecorder::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ANSLoadTestRecorder::OnPostGarbageCollect);
+
+	if (!IFileManager::Get().FileExists(*CsvPath)) {
+		FFileHelper::SaveStringToFile(TEXT("time_s,players,connections,tick_p50_ms,tick_p95_ms,tick_p99_ms,tick_max_ms,out_bytes_per_conn_s,in_bytes_per_conn_s,rpcs_per_s,gc_count,gc_max_ms\n"), *CsvPath);
+	}
+	UE_LOG(LogTemp, Display, TEXT("Load test: writing %s every %.0f s"), *CsvPath, Window);
+}
+
+void ANSLoadTestRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Flush();
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ANSLoadTestRecorder::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
+
+	//최대 틱 레이트를 맞추려고 쉰 시간은 빼서 실제로 일한 시간만 잰다
+	TickTimes.Add((float)(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0));
+
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver) {
+		for (UNetConnection* Connection : NetDriver->ClientConnections) {
+			OutBytesPerSecondSum += Connection->OutBytesPerSecond;
+			InBytesPerSecondSum += Connection->InBytesPerSecond;
+			NumConnectionSamples++;
+		}
+	}
+
+	if (FPlatformTime::Seconds() - WindowStartTime >= Window) {
+		Flush();
+	}
+}
+
+void ANSLoadTestRecorder::Flush()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - WindowStartTime;
+	if (TickTimes.Num() == 0 || Elapsed <= 0.0) {
+		return;
+	}
+
+	TickTimes.Sort();
+	auto Percentile = [this](float P)
+	{
+		return TickTimes[FMath::Min(FMath::FloorToInt(P * TickTimes.Num()), TickTimes.Num() - 1)];
+	};
+
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	AGameStateBase* thisGameState = GetWorld()->GetGameState();
+	const int32 NumPlayers = thisGameState ? thisGameState->PlayerArray.Num() : 0;
+
+	const FString Line = FString::Printf(TEXT("%.1f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f,%.1f,%d,%.3f\n"),
+		GetWorld()->GetTimeSeconds(), NumPlayers, NumConnections,
+		Percentile(0.5f), Percentile(0.95f), Percentile(0.99f), TickTimes.Last(),
+		NumConnectionSamples > 0 ? (double)OutBytesPerSecondSum / NumConnectionSamples : 0.0,
+		NumConnectionSamples > 0 ? (double)InBytesPerSecondSum / NumConnectionSamples : 0.0,
+		NumRPCs / Elapsed, NumGCs, MaxGCTime * 1000.0);
+	FFileHelper::SaveStringToFile(Line, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	TickTimes.Reset();
+	OutBytesPerSecondSum = 0;
+	InBytesPerSecondSum = 0;
+	NumConnectionSamples = 0;
+	NumRPCs = 0;
+	NumGCs = 0;
+	MaxGCTime = 0.0;
+	WindowStartTime = Now;
+}
+
+void ANSLoadTestRecorder::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void ANSLoadTestRecorder::OnPostGarbageCollect()
+{
+	NumGCs++;
+	MaxGCTime = FMath::Max(MaxGCTime, FPlatformTime::Seconds() - GCStartTime);
+}
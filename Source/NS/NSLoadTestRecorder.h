@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NSLoadTestRecorder.generated.h"
+
+/**
+ * 서버 부하 측정기.
+ * -NSLoadTestCsv=<경로>로 실행한 서버에서만 만들어지며, 일정 주기마다 CSV 한 줄을 덧붙인다.
+ * 틱 시간 백분위(최대 틱 레이트 대기 시간 제외), 연결당 대역폭, 초당 게임플레이 RPC 수, GC 정지 시간을 기록한다.
+ */
+UCLASS()
+class NS_API ANSLoadTestRecorder : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSLoadTestRecorder();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** 명령줄에 CSV 경로가 있으면 측정기를 만든다 */
+	static void StartIfRequested(UWorld* World);
+
+	/** 서버가 받은 게임플레이 RPC 하나를 센다 */
+	static void CountRPC() { NumRPCs++; }
+
+private:
+	void Flush();
+
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	static int32 NumRPCs;
+
+	FString CsvPath;
+
+	/** 한 줄을 쓰는 주기(초) */
+	float Window;
+	double WindowStartTime;
+
+	TArray<float> TickTimes;
+	int64 OutBytesPerSecondSum;
+	int64 InBytesPerSecondSum;
+	int32 NumConnectionSamples;
+
+	int32 NumGCs;
+	double MaxGCTime;
+	double GCStartTime;
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
@@ -1,19 +1,292 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "NSPlayerState.h"
+#include "NS.h"
+#include "NSGameState.h"
+#include "Engine/World.h"
 #include "Net/UnrealNetwork.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("PlayerState Replications"), STAT_NSPlayerStateReplications, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("PlayerState Replicated Bits"), STAT_NSPlayerStateReplicatedBits, STATGROUP_NS);
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	/** 연결 하나에 대한 플레이어 상태 복제 비용 */
+	struct FNSReplicationCost
+	{
+		FString Name;
+		int32 Replications;
+		int64 BitsWritten;
+
+		FNSReplicationCost()
+			: Replications(0)
+			, BitsWritten(0)
+		{
+		}
+	};
+
+	TMap<TWeakObjectPtr<UNetConnection>, FNSReplicationCost> ReplicationCosts;
+	double ReplicationCostStartTime = 0.0;
+}
+#endif
 
 ANSPlayerState::ANSPlayerState(const FObjectInitializer& ObjectInitializer)
-: Super(ObjectInitializer) 
+: Super(ObjectInitializer)
 {
 	Health = 100.0f;
+	ReplicatedHealth = 100;
 	Deaths = 0;
 	Team = ETeam::BLUE_TEAM;
+	Revision = 0;
+
+	//값이 바뀌면 ForceNetUpdate로 바로 보내므로 평소 갱신은 느리게 둔다
+	NetUpdateFrequency = 1.0f;
 }
 
 void ANSPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(ANSPlayerState, Health);
+	DOREPLIFETIME_CONDITION(ANSPlayerState, ReplicatedHealth, COND_ReplayOrOwner);
+	DOREPLIFETIME_CONDITION(ANSPlayerState, SpectatedHealth, COND_OwnerOnly);
 	DOREPLIFETIME(ANSPlayerState, Deaths);
-	DOREPLIFETIME(ANSPlayerState, Team);
-}
\ No newline at end of file
+	DOREPLIFETIME_CONDITION(ANSPlayerState, Team, COND_InitialOnly);
+}
+
+void ANSPlayerState::SetHealth(float NewHealth)
+{
+	NewHealth = FMath::Clamp(NewHealth, 0.0f, 255.0f);
+	if (NewHealth != Health) {
+		Health = NewHealth;
+		MarkChanged();
+	}
+
+	//소수점은 올려서 살아 있는 동안에는 0이 되지 않게 한다
+	const uint8 NewReplicatedHealth = (uint8)FMath::CeilToInt(Health);
+	if (NewReplicatedHealth != ReplicatedHealth) {
+		ReplicatedHealth = NewReplicatedHealth;
+		ForceNetUpdate();
+
+		//관전자는 자기 플레이어 상태로 받으므로 그쪽도 바로 보내게 한다. 목록은 PreReplication에서 채운다
+		AGameStateBase* thisGameState = GetWorld() ? GetWorld()->GetGameState() : nullptr;
+		if (thisGameState) {
+			for (APlayerState* thisPS : thisGameState->PlayerArray) {
+				if (thisPS && thisPS != this && (thisPS->bOnlySpectator || thisPS->bIsSpectator)) {
+					thisPS->ForceNetUpdate();
+				}
+			}
+		}
+	}
+}
+
+void ANSPlayerState::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	//관전자가 아니면 목록은 비어 있고 비교하지도 않는다
+	const bool bSpectating = IsSpectating();
+	DOREPLIFETIME_ACTIVE_OVERRIDE(ANSPlayerState, SpectatedHealth, bSpectating);
+	if (bSpectating) {
+		UpdateSpectatedHealth();
+	}
+	else if (SpectatedHealth.Num() > 0) {
+		SpectatedHealth.Reset();
+	}
+}
+
+void ANSPlayerState::UpdateSpectatedHealth()
+{
+	AGameStateBase* thisGameState = GetWorld()->GetGameState();
+	if (thisGameState == nullptr) {
+		return;
+	}
+
+	//같은 배열을 제자리에서 다시 채워서 평소에는 할당이 없다
+	SpectatedHealth.SetNum(thisGameState->PlayerArray.Num(), false);
+	int32 Num = 0;
+	for (APlayerState* thisPS : thisGameState->PlayerArray) {
+		const ANSPlayerState* OtherPS = Cast<ANSPlayerState>(thisPS);
+		if (OtherPS == nullptr || OtherPS == this || OtherPS->IsSpectating()) {
+			continue;
+		}
+		SpectatedHealth[Num].PlayerId = OtherPS->PlayerId;
+		SpectatedHealth[Num].Health = OtherPS->ReplicatedHealth;
+		Num++;
+	}
+	SpectatedHealth.SetNum(Num, false);
+}
+
+void ANSPlayerState::ApplySpectatedHealth()
+{
+	AGameStateBase* thisGameState = GetWorld() ? GetWorld()->GetGameState() : nullptr;
+	if (thisGameState == nullptr) {
+		return;
+	}
+
+	//아직 복제되지 않은 플레이어는 건너뛰고, 그 상태가 들어올 때 게임 스테이트가 다시 부른다
+	for (const FNSSpectatedHealth& Entry : SpectatedHealth) {
+		for (APlayerState* thisPS : thisGameState->PlayerArray) {
+			ANSPlayerState* OtherPS = Cast<ANSPlayerState>(thisPS);
+			if (OtherPS == nullptr || OtherPS->PlayerId != Entry.PlayerId) {
+				continue;
+			}
+			if (OtherPS->Health != Entry.Health) {
+				OtherPS->Health = Entry.Health;
+				OtherPS->MarkChanged();
+			}
+			break;
+		}
+	}
+}
+
+void ANSPlayerState::AddDeath()
+{
+	Deaths++;
+	MarkChanged();
+	ForceNetUpdate();
+}
+
+void ANSPlayerState::AddScore(float Amount)
+{
+	Score += Amount;
+	MarkChanged();
+	ForceNetUpdate();
+}
+
+void ANSPlayerState::SetTeam(ETeam NewTeam)
+{
+	if (Team != NewTeam) {
+		Team = NewTeam;
+		MarkChanged();
+		//채널이 열리기 전이면 무시되고 최초 복제로 전달된다
+		MultiCastTeamChanged(NewTeam);
+	}
+}
+
+void ANSPlayerState::ResetMatchStats()
+{
+	Score = 0.0f;
+	Deaths = 0;
+	MarkChanged();
+	ForceNetUpdate();
+}
+
+void ANSPlayerState::CopyProperties(APlayerState* PlayerState)
+{
+	Super::CopyProperties(PlayerState);
+
+	//팀은 최초 복제로만 가므로 새 상태가 처음 복제되기 전인 지금 바로 넣는다
+	ANSPlayerState* NewPS = Cast<ANSPlayerState>(PlayerState);
+	if (NewPS) {
+		NewPS->Team = Team;
+		NewPS->Deaths = Deaths;
+		NewPS->MarkChanged();
+	}
+}
+
+void ANSPlayerState::OnRep_ReplicatedHealth()
+{
+	Health = ReplicatedHealth;
+	MarkChanged();
+}
+
+void ANSPlayerState::OnRep_SpectatedHealth()
+{
+	ApplySpectatedHealth();
+}
+
+void ANSPlayerState::OnRep_Deaths()
+{
+	MarkChanged();
+}
+
+void ANSPlayerState::OnRep_Team()
+{
+	MarkChanged();
+}
+
+void ANSPlayerState::OnRep_Score()
+{
+	Super::OnRep_Score();
+	MarkChanged();
+}
+
+void ANSPlayerState::OnRep_PlayerName()
+{
+	Super::OnRep_PlayerName();
+	MarkChanged();
+}
+
+void ANSPlayerState::MarkChanged()
+{
+	Revision++;
+	ANSGameState* thisGameState = GetWorld() ? GetWorld()->GetGameState<ANSGameState>() : nullptr;
+	if (thisGameState) {
+		thisGameState->UpdateScoreboard(this);
+	}
+}
+
+void ANSPlayerState::MultiCastTeamChanged_Implementation(ETeam NewTeam)
+{
+	if (Team != NewTeam) {
+		Team = NewTeam;
+		MarkChanged();
+	}
+}
+
+bool ANSPlayerState::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	//연결마다 복제 패스가 돌 때 호출된다. 이 시점의 번치 크기가 이번에 쓴 속성 비트 수다
+#if !UE_BUILD_SHIPPING
+	UNetConnection* Connection = Channel ? Channel->Connection : nullptr;
+	if (Connection && Bunch) {
+		FNSReplicationCost& Cost = ReplicationCosts.FindOrAdd(Connection);
+		if (Cost.Name.IsEmpty()) {
+			Cost.Name = Connection->LowLevelGetRemoteAddress(true);
+		}
+		Cost.Replications++;
+		Cost.BitsWritten += Bunch->GetNumBits();
+
+		INC_DWORD_STAT(STAT_NSPlayerStateReplications);
+		INC_DWORD_STAT_BY(STAT_NSPlayerStateReplicatedBits, Bunch->GetNumBits());
+	}
+#endif
+
+	return Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommand NSPlayerStateRepCostCommand(
+	TEXT("ns.PlayerStateRepCost"),
+	TEXT("Logs player state replication passes and bits per connection since the last reset. Args: [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double Elapsed = FMath::Max(Now - ReplicationCostStartTime, 0.001);
+
+		if (Args.Num() == 0 || Args[0] != TEXT("reset")) {
+			int32 TotalReplications = 0;
+			int64 TotalBits = 0;
+			for (const auto& Pair : ReplicationCosts) {
+				if (!Pair.Key.IsValid()) {
+					continue;
+				}
+				const FNSReplicationCost& Cost = Pair.Value;
+				UE_LOG(LogTemp, Display, TEXT("%s: %d passes (%.1f/s), %d bytes (%.1f B/s)"),
+					*Cost.Name, Cost.Replications, Cost.Replications / Elapsed, (int32)(Cost.BitsWritten / 8), Cost.BitsWritten / 8 / Elapsed);
+				TotalReplications += Cost.Replications;
+				TotalBits += Cost.BitsWritten;
+			}
+			UE_LOG(LogTemp, Display, TEXT("Total over %.1f s: %d passes (%.1f/s), %lld bytes (%.1f B/s)"),
+				Elapsed, TotalReplications, TotalReplications / Elapsed, TotalBits / 8, TotalBits / 8 / Elapsed);
+		}
+
+		ReplicationCosts.Reset();
+		ReplicationCostStartTime = Now;
+	})
+);
+
+#endif
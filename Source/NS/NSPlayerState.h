@@ -5,25 +5,119 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerState.h"
 #include "NSSGameMode.h"
+#include "NSShotValidation.h"
 #include "NSPlayerState.generated.h"
 
+/** 관전자에게 보내는 다른 플레이어 한 명의 양자화 체력 */
+USTRUCT()
+struct FNSSpectatedHealth
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 PlayerId;
+
+	UPROPERTY()
+	uint8 Health;
+
+	FNSSpectatedHealth()
+		: PlayerId(0)
+		, Health(0)
+	{
+	}
+};
+
 /**
- * 
+ * 플레이어 상태.
+ * 값은 세터로만 바꾸고, 바뀌었을 때만 ForceNetUpdate로 복제를 요청한다.
+ * 평소에는 갱신 빈도를 낮게 두어 서버가 매 프레임 속성을 비교하지 않는다.
  */
 UCLASS()
 class NS_API ANSPlayerState : public APlayerState
 {
 	GENERATED_UCLASS_BODY()
 
+public:
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/** 심리스 트래블로 새 맵의 플레이어 상태에 팀과 기록을 넘긴다 */
+	virtual void CopyProperties(APlayerState* PlayerState) override;
+
+	float GetHealth() const { return Health; }
+	uint8 GetDeaths() const { return Deaths; }
+	ETeam GetTeam() const { return Team; }
+
+	/** 관전 전용으로 들어왔거나 관전 중인 플레이어 */
+	bool IsSpectating() const { return bOnlySpectator || bIsSpectator; }
+
+	/** 클라이언트 전용. 관전자인 내 플레이어 상태가 받은 체력을 다른 플레이어 상태들에 채운다 */
+	void ApplySpectatedHealth();
+
+	/** 서버 전용. 0~255로 잘라 저장한다 */
+	void SetHealth(float NewHealth);
+	void AddDeath();
+	void AddScore(float Amount);
+	void SetTeam(ETeam NewTeam);
+
+	/** 매치가 시작될 때 점수와 데스를 지운다 */
+	void ResetMatchStats();
+
+	/** 체력, 점수, 데스, 팀, 이름 중 하나가 바뀔 때마다 올라간다. HUD는 이 값이 같으면 글자를 다시 만들지 않는다 */
+	uint32 GetRevision() const { return Revision; }
 
-	UPROPERTY(Replicated)
+	virtual void OnRep_Score() override;
+	virtual void OnRep_PlayerName() override;
+
+	/** 서버 전용. 폰이 바뀌어도 연결 단위로 유지된다 */
+	FNSShotValidator& GetShotValidator() { return ShotValidator; }
+	const FNSShotValidator& GetShotValidator() const { return ShotValidator; }
+
+private:
+	UFUNCTION()
+	void OnRep_ReplicatedHealth();
+
+	UFUNCTION()
+	void OnRep_SpectatedHealth();
+
+	UFUNCTION()
+	void OnRep_Deaths();
+
+	UFUNCTION()
+	void OnRep_Team();
+
+	/** 서버 전용. 관전자의 SpectatedHealth를 다른 플레이어들의 체력으로 다시 채운다 */
+	void UpdateSpectatedHealth();
+
+	/** 표시 값이 바뀌었음을 HUD와 스코어보드에 알린다. 서버는 세터에서, 클라이언트는 OnRep에서 부른다 */
+	void MarkChanged();
+
+	/** 처음 복제된 뒤에 팀이 바뀌면 이걸로 알린다 */
+	UFUNCTION(NetMulticast, Reliable)
+	void MultiCastTeamChanged(ETeam NewTeam);
+
+	/** 서버의 체력. 클라이언트에서는 ReplicatedHealth로부터 채워진다 */
 	float Health;
 
-	UPROPERTY(Replicated)
+	/** 바이트로 양자화한 체력. 소유자와 리플레이에만 보낸다. 관전자는 자기 플레이어 상태의 SpectatedHealth로 받는다 */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedHealth)
+	uint8 ReplicatedHealth;
+
+	/**
+	 * 관전자의 플레이어 상태에만 채워서 그 소유자(관전자 연결)에게만 보낸다.
+	 * 4.19에는 연결별 조건이 없어서 다른 플레이어의 체력을 관전자에게만 보내려면 관전자 쪽 상태에 싣는다
+	 */
+	UPROPERTY(ReplicatedUsing = OnRep_SpectatedHealth)
+	TArray<FNSSpectatedHealth> SpectatedHealth;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Deaths)
 	uint8 Deaths;
 
-	UPROPERTY(Replicated)
+	/** 처음 한 번만 복제한다 */
+	UPROPERTY(ReplicatedUsing = OnRep_Team)
 	ETeam Team;
-	
 
+	uint32 Revision;
+
+	FNSShotValidator ShotValidator;
 };
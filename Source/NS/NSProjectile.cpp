@@ -3,6 +3,9 @@
 #include "NSProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+#include "NSProjectilePool.h"
 
 ANSProjectile::ANSProjectile() 
 {
@@ -29,6 +32,85 @@ ANSProjectile::ANSProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+	PooledLifeSpan = 3.0f;
+
+	bReplicates = true;
+	bReplicateMovement = true;
+	bPooledActive = true;
+	Pool = nullptr;
+}
+
+void ANSProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME(ANSProjectile, bPooledActive);
+}
+
+void ANSProjectile::SetPool(ANSProjectilePool* InPool)
+{
+	Pool = InPool;
+	SetLifeSpan(0.0f);
+	bPooledActive = false;
+	ApplyPooledActive();
+}
+
+void ANSProjectile::ActivateFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	bPooledActive = true;
+	ApplyPooledActive();
+
+	// Restart movement from scratch, as if freshly spawned
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+
+	// Wake up replication; recycled projectiles sit dormant in the pool
+	SetNetDormancy(DORM_Awake);
+	ForceNetUpdate();
+
+	GetWorldTimerManager().SetTimer(LifeSpanTimer, this, &ANSProjectile::Recycle, PooledLifeSpan, false);
+}
+
+void ANSProjectile::Recycle()
+{
+	if (Pool == nullptr) {
+		Destroy();
+		return;
+	}
+	if (!bPooledActive) {
+		return;
+	}
+
+	GetWorldTimerManager().ClearTimer(LifeSpanTimer);
+	bPooledActive = false;
+	ApplyPooledActive();
+
+	// Send the hidden state once, then stop replicating until reused
+	ForceNetUpdate();
+	SetNetDormancy(DORM_DormantAll);
+
+	Pool->Release(this);
+}
+
+void ANSProjectile::OnRep_PooledActive()
+{
+	ApplyPooledActive();
+}
+
+void ANSProjectile::ApplyPooledActive()
+{
+	SetActorHiddenInGame(!bPooledActive);
+	SetActorEnableCollision(bPooledActive);
+
+	if (bPooledActive) {
+		ProjectileMovement->SetActive(true, true);
+	}
+	else {
+		ProjectileMovement->StopMovementImmediately();
+		ProjectileMovement->SetActive(false);
+	}
 }
 
 void ANSProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -38,6 +120,8 @@ void ANSProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPri
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
-		Destroy();
+		if (Role == ROLE_Authority) {
+			Recycle();
+		}
 	}
 }
\ No newline at end of file
@@ -26,6 +26,37 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Puts a pooled projectile back into play at the given transform */
+	void ActivateFromPool(const FVector& Location, const FRotator& Rotation);
+
+	/** Hides the projectile and hands it back to its pool, or destroys it if it isn't pooled */
+	void Recycle();
+
+	/** Marks this projectile as owned by Pool; it will be recycled instead of destroyed */
+	void SetPool(class ANSProjectilePool* InPool);
+
+	/** Lifetime of a pooled projectile, replaces InitialLifeSpan once pooled */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float PooledLifeSpan;
+
+protected:
+	UFUNCTION()
+	void OnRep_PooledActive();
+
+	/** Applies visibility, collision and movement for the current bPooledActive state */
+	void ApplyPooledActive();
+
+	/** Whether a pooled projectile is currently in flight; replicated so clients hide recycled ones */
+	UPROPERTY(ReplicatedUsing = OnRep_PooledActive)
+	bool bPooledActive;
+
+	UPROPERTY()
+	class ANSProjectilePool* Pool;
+
+	FTimerHandle LifeSpanTimer;
+
+public:
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSProjectilePool.h"
+#include "NS.h"
+#include "NSProjectile.h"
+#include "NSSGameMode.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+#include "NSTickAudit.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Reuses"), STAT_NSProjectilePoolReuses, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Pool Spawns"), STAT_NSProjectilePoolSpawns, STATGROUP_NS);
+
+ANSProjectilePool::ANSProjectilePool()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bReplicates = false;
+
+	PrewarmCount = 64;
+
+	StressRate = 0.0f;
+	StressTimeLeft = 0.0f;
+	StressSpawnDebt = 0.0f;
+	bStressUsePool = true;
+	StressFrames = 0;
+	StressShots = 0;
+	StressFrameTime = 0.0;
+	StressMaxFrameTime = 0.0;
+	StressGCTime = 0.0;
+	GCStartTime = 0.0;
+}
+
+ANSProjectilePool* ANSProjectilePool::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	ANSSGameMode* thisGameMode = World ? Cast<ANSSGameMode>(World->GetAuthGameMode()) : nullptr;
+	return thisGameMode ? thisGameMode->GetProjectilePool() : nullptr;
+}
+
+ANSProjectile* ANSProjectilePool::Create(TSubclassOf<ANSProjectile> ProjectileClass)
+{
+	INC_DWORD_STAT(STAT_NSProjectilePoolSpawns);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ANSProjectile* Projectile = GetWorld()->SpawnActor<ANSProjectile>(ProjectileClass, GetActorLocation(), FRotator::ZeroRotator, SpawnParams);
+	if (Projectile) {
+		Projectile->SetPool(this);
+		Pools.FindOrAdd(ProjectileClass).NumCreated++;
+	}
+	return Projectile;
+}
+
+void ANSProjectilePool::Prewarm(TSubclassOf<ANSProjectile> ProjectileClass, int32 Count)
+{
+	if (ProjectileClass == nullptr) {
+		return;
+	}
+
+	FNSProjectileList& List = Pools.FindOrAdd(ProjectileClass);
+	List.Free.Reserve(List.Free.Num() + Count);
+	for (int32 i = 0; i < Count; i++) {
+		ANSProjectile* Projectile = Create(ProjectileClass);
+		if (Projectile) {
+			//휴면으로 시작해서 채널을 열지 않는다
+			Projectile->SetNetDormancy(DORM_DormantAll);
+			List.Free.Add(Projectile);
+		}
+	}
+}
+
+ANSProjectile* ANSProjectilePool::Acquire(TSubclassOf<ANSProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator)
+{
+	if (ProjectileClass == nullptr) {
+		return nullptr;
+	}
+
+	FNSProjectileList& List = Pools.FindOrAdd(ProjectileClass);
+	ANSProjectile* Projectile = nullptr;
+	while (Projectile == nullptr && List.Free.Num() > 0) {
+		Projectile = List.Free.Pop(false);
+		if (Projectile && Projectile->IsPendingKill()) {
+			Projectile = nullptr;
+		}
+	}
+
+	if (Projectile) {
+		INC_DWORD_STAT(STAT_NSProjectilePoolReuses);
+	}
+	else {
+		Projectile = Create(ProjectileClass);
+		if (Projectile == nullptr) {
+			return nullptr;
+		}
+	}
+
+	Projectile->SetOwner(ProjectileOwner);
+	Projectile->Instigator = ProjectileInstigator;
+	Projectile->ActivateFromPool(Location, Rotation);
+	return Projectile;
+}
+
+void ANSProjectilePool::Release(ANSProjectile* Projectile)
+{
+	Projectile->SetOwner(nullptr);
+	Projectile->Instigator = nullptr;
+	Pools.FindOrAdd(Projectile->GetClass()).Free.Add(Projectile);
+}
+
+void ANSProjectilePool::StartStressTest(TSubclassOf<ANSProjectile> ProjectileClass, float Rate, float Duration, bool bUsePool)
+{
+	StressClass = ProjectileClass;
+	StressRate = Rate;
+	StressTimeLeft = Duration;
+	StressSpawnDebt = 0.0f;
+	bStressUsePool = bUsePool;
+	StressFrames = 0;
+	StressShots = 0;
+	StressFrameTime = 0.0;
+	StressMaxFrameTime = 0.0;
+	StressGCTime = 0.0;
+
+	if (!PreGCHandle.IsValid()) {
+		PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &ANSProjectilePool::OnPreGarbageCollect);
+		PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ANSProjectilePool::OnPostGarbageCollect);
+	}
+	SetActorTickEnabled(true);
+}
+
+void ANSProjectilePool::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
+
+	if (StressTimeLeft <= 0.0f) {
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	StressFrames++;
+	StressFrameTime += DeltaSeconds;
+	StressMaxFrameTime = FMath::Max(StressMaxFrameTime, (double)DeltaSeconds);
+
+	//첫 번째 플레이어 시점에서 원뿔 모양으로 흩뿌린다
+	FVector ViewLocation = GetActorLocation();
+	FRotator ViewRotation = FRotator::ZeroRotator;
+	APlayerController* thisPC = GetWorld()->GetFirstPlayerController();
+	if (thisPC) {
+		thisPC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	}
+
+	StressSpawnDebt += StressRate * DeltaSeconds;
+	while (StressSpawnDebt >= 1.0f) {
+		StressSpawnDebt -= 1.0f;
+		StressShots++;
+
+		const FRotator ShotRotation = FMath::VRandCone(ViewRotation.Vector(), FMath::DegreesToRadians(30.0f)).Rotation();
+		const FVector ShotLocation = ViewLocation + ShotRotation.Vector() * 100.0f;
+		if (bStressUsePool) {
+			Acquire(StressClass, ShotLocation, ShotRotation, nullptr, nullptr);
+		}
+		else {
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			GetWorld()->SpawnActor<ANSProjectile>(StressClass, ShotLocation, ShotRotation, SpawnParams);
+		}
+	}
+
+	StressTimeLeft -= DeltaSeconds;
+	if (StressTimeLeft <= 0.0f) {
+		UE_LOG(LogTemp, Display, TEXT("Projectile stress (%s): %d shots, %d frames, avg frame %.2f ms, max frame %.2f ms, GC %.2f ms total"),
+			bStressUsePool ? TEXT("pooled") : TEXT("spawn/destroy"), StressShots, StressFrames,
+			StressFrames > 0 ? StressFrameTime * 1000.0 / StressFrames : 0.0, StressMaxFrameTime * 1000.0, StressGCTime * 1000.0);
+		SetActorTickEnabled(false);
+	}
+}
+
+void ANSProjectilePool::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void ANSProjectilePool::OnPostGarbageCollect()
+{
+	if (StressTimeLeft > 0.0f) {
+		StressGCTime += FPlatformTime::Seconds() - GCStartTime;
+	}
+}
+
+void ANSProjectilePool::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs NSProjectileStressCommand(
+	TEXT("ns.ProjectileStress"),
+	TEXT("Fires projectiles from the first player's view and logs frame and GC time. Args: [PerSecond=1000] [Seconds=10] [UsePool=1]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		ANSProjectilePool* Pool = ANSProjectilePool::Get(World);
+		ANSSGameMode* thisGameMode = World ? Cast<ANSSGameMode>(World->GetAuthGameMode()) : nullptr;
+		if (Pool == nullptr || thisGameMode == nullptr) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.ProjectileStress must run on the server"));
+			return;
+		}
+
+		const float Rate = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 1000.0f;
+		const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.0f;
+		const bool bUsePool = Args.Num() > 2 ? FCString::Atoi(*Args[2]) != 0 : true;
+		Pool->StartStressTest(thisGameMode->GetProjectileClass(), Rate, Duration, bUsePool);
+	})
+);
+
+#endif
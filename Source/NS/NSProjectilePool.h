@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NSProjectilePool.generated.h"
+
+class ANSProjectile;
+
+/** 클래스 하나에 대한 쉬고 있는 발사체 목록 */
+USTRUCT()
+struct FNSProjectileList
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<ANSProjectile*> Free;
+
+	/** 이 클래스로 만든 전체 발사체 수 */
+	int32 NumCreated;
+
+	FNSProjectileList()
+		: NumCreated(0)
+	{
+	}
+};
+
+/**
+ * 서버의 발사체 풀.
+ * 맵 로드 때 발사체를 미리 만들어 두고, 명중하거나 수명이 다하면 Destroy 대신 숨겨서 돌려받는다.
+ * 쉬고 있는 발사체는 넷 휴면 상태라 채널 비용이 없다.
+ */
+UCLASS(config=Game)
+class NS_API ANSProjectilePool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSProjectilePool();
+
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** 서버 게임 모드가 가진 풀을 얻는다 */
+	static ANSProjectilePool* Get(const UObject* WorldContextObject);
+
+	/** Count개를 미리 만들어 둔다 */
+	void Prewarm(TSubclassOf<ANSProjectile> ProjectileClass, int32 Count);
+
+	/** 풀에서 발사체를 꺼내 발사한다. 비어 있으면 하나 더 만든다 */
+	ANSProjectile* Acquire(TSubclassOf<ANSProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator);
+
+	/** ANSProjectile::Recycle()에서 호출한다 */
+	void Release(ANSProjectile* Projectile);
+
+	/** 맵 로드 때 미리 만들 개수 */
+	UPROPERTY(config, EditAnywhere, Category = Projectile)
+	int32 PrewarmCount;
+
+	/**
+	 * 초당 Rate발을 Duration초 동안 쏘면서 프레임 시간과 GC 시간을 잰다.
+	 * bUsePool이 false면 매번 SpawnActor/Destroy를 해서 비교 기준을 만든다.
+	 */
+	void StartStressTest(TSubclassOf<ANSProjectile> ProjectileClass, float Rate, float Duration, bool bUsePool);
+
+private:
+	ANSProjectile* Create(TSubclassOf<ANSProjectile> ProjectileClass);
+
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	UPROPERTY()
+	TMap<UClass*, FNSProjectileList> Pools;
+
+	/** 스트레스 테스트 상태 */
+	UPROPERTY()
+	TSubclassOf<ANSProjectile> StressClass;
+	float StressRate;
+	float StressTimeLeft;
+	float StressSpawnDebt;
+	bool bStressUsePool;
+	int32 StressFrames;
+	int32 StressShots;
+	double StressFrameTime;
+	double StressMaxFrameTime;
+	double StressGCTime;
+	double GCStartTime;
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
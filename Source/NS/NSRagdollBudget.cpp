@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSRagdollBudget.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "NSGameState.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "EngineUtils.h"
+#include "NSTickAudit.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Active"), STAT_NSRagdollsActive, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ragdolls Frozen"), STAT_NSRagdollsFrozen, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ragdolls Skipped"), STAT_NSRagdollsSkipped, STATGROUP_NS);
+
+ANSRagdollBudget::ANSRagdollBudget()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bReplicates = false;
+
+	MaxRagdolls = 6;
+	RagdollDistance = 4000.0f;
+	SettleSpeed = 10.0f;
+	SettleTime = 0.5f;
+	MaxRagdollTime = 5.0f;
+}
+
+ANSRagdollBudget* ANSRagdollBudget::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer) {
+		return nullptr;
+	}
+
+	//이펙트 풀처럼 게임 스테이트에 달아 둔다
+	ANSGameState* thisGameState = World->GetGameState<ANSGameState>();
+	if (thisGameState == nullptr) {
+		return nullptr;
+	}
+	if (thisGameState->RagdollBudget == nullptr) {
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		thisGameState->RagdollBudget = World->SpawnActor<ANSRagdollBudget>(SpawnParams);
+	}
+	return thisGameState->RagdollBudget;
+}
+
+bool ANSRagdollBudget::RequestRagdoll(ANSCharacter* Character)
+{
+	if (MaxRagdolls <= 0) {
+		INC_DWORD_STAT(STAT_NSRagdollsSkipped);
+		return false;
+	}
+
+	//자기 자신의 죽음은 거리와 상관없이 래그돌로 보여준다
+	APlayerController* thisPC = GetWorld()->GetFirstPlayerController();
+	if (thisPC && thisPC->PlayerCameraManager && !Character->IsLocallyControlled()) {
+		const float DistSquared = FVector::DistSquared(thisPC->PlayerCameraManager->GetCameraLocation(), Character->GetActorLocation());
+		if (DistSquared > FMath::Square(RagdollDistance)) {
+			INC_DWORD_STAT(STAT_NSRagdollsSkipped);
+			return false;
+		}
+	}
+
+	//가까운 사망이 더 잘 보이므로 가장 오래된 래그돌을 고정하고 자리를 내준다
+	while (ActiveRagdolls.Num() >= MaxRagdolls) {
+		Freeze(ActiveRagdolls[0].Character.Get());
+		ActiveRagdolls.RemoveAt(0, 1, false);
+		DEC_DWORD_STAT(STAT_NSRagdollsActive);
+	}
+
+	FActiveRagdoll& Ragdoll = ActiveRagdolls[ActiveRagdolls.AddUninitialized()];
+	Ragdoll.Character = Character;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+	Ragdoll.SettleStartTime = -1.0f;
+	INC_DWORD_STAT(STAT_NSRagdollsActive);
+
+	SetActorTickEnabled(true);
+	return true;
+}
+
+void ANSRagdollBudget::Release(ANSCharacter* Character)
+{
+	for (int32 i = 0; i < ActiveRagdolls.Num(); i++) {
+		if (ActiveRagdolls[i].Character == Character) {
+			ActiveRagdolls.RemoveAt(i, 1, false);
+			DEC_DWORD_STAT(STAT_NSRagdollsActive);
+			return;
+		}
+	}
+}
+
+int32 ANSRagdollBudget::GetNumActiveBodies() const
+{
+	int32 NumBodies = 0;
+	for (const FActiveRagdoll& Ragdoll : ActiveRagdolls) {
+		if (const ANSCharacter* thisChar = Ragdoll.Character.Get()) {
+			NumBodies += thisChar->GetMesh()->Bodies.Num();
+		}
+	}
+	return NumBodies;
+}
+
+void ANSRagdollBudget::Freeze(ANSCharacter* Character)
+{
+	if (Character == nullptr) {
+		return;
+	}
+	INC_DWORD_STAT(STAT_NSRagdollsFrozen);
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	//재우기만 하면 다른 래그돌이나 발사체에 부딪혀 다시 깨어나 예산 밖에서 시뮬레이션한다.
+	//시뮬레이션과 충돌을 아예 끄고, 애니메이션이 포즈를 덮어쓰지 않도록 틱도 멈춘다
+	Mesh->SetAllBodiesSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetComponentTickEnabled(false);
+}
+
+void ANSRagdollBudget::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (int32 i = ActiveRagdolls.Num() - 1; i >= 0; i--) {
+		FActiveRagdoll& Ragdoll = ActiveRagdolls[i];
+		ANSCharacter* thisChar = Ragdoll.Character.Get();
+		if (thisChar == nullptr) {
+			ActiveRagdolls.RemoveAt(i, 1, false);
+			DEC_DWORD_STAT(STAT_NSRagdollsActive);
+			continue;
+		}
+
+		//루트 바디 속도로 멈췄는지 본다
+		const float Speed = thisChar->GetMesh()->GetPhysicsLinearVelocity().Size();
+		if (Speed > SettleSpeed) {
+			Ragdoll.SettleStartTime = -1.0f;
+		}
+		else if (Ragdoll.SettleStartTime < 0.0f) {
+			Ragdoll.SettleStartTime = Now;
+		}
+
+		const bool bSettled = Ragdoll.SettleStartTime >= 0.0f && Now - Ragdoll.SettleStartTime >= SettleTime;
+		if (bSettled || Now - Ragdoll.StartTime >= MaxRagdollTime) {
+			Freeze(thisChar);
+			ActiveRagdolls.RemoveAt(i, 1, false);
+			DEC_DWORD_STAT(STAT_NSRagdollsActive);
+		}
+	}
+
+	if (ActiveRagdolls.Num() == 0) {
+		SetActorTickEnabled(false);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+/**
+ * ns.RagdollCost가 여러 프레임에 걸쳐 게임 스레드 시간과 시뮬레이션 중인 래그돌 수를 모은다.
+ * 서버에서는 예산이 없으니 물리를 시뮬레이션하는 캐릭터 메시를 직접 센다
+ */
+struct FNSRagdollCostTimer
+{
+	TWeakObjectPtr<UWorld> World;
+	int32 FramesLeft = 0;
+	int32 Frames = 0;
+	double TotalTime = 0.0;
+	double MaxTime = 0.0;
+	int32 TotalRagdolls = 0;
+	int32 MaxRagdolls = 0;
+	int32 MaxBodies = 0;
+	int32 MaxSimulatingMeshes = 0;
+	FDelegateHandle PostHandle;
+
+	void Start(UWorld* InWorld, int32 NumFrames)
+	{
+		Stop();
+		World = InWorld;
+		FramesLeft = NumFrames;
+		Frames = 0;
+		TotalTime = 0.0;
+		MaxTime = 0.0;
+		TotalRagdolls = 0;
+		MaxRagdolls = 0;
+		MaxBodies = 0;
+		MaxSimulatingMeshes = 0;
+		PostHandle = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FNSRagdollCostTimer::OnPostActorTick);
+	}
+
+	void Stop()
+	{
+		FWorldDelegates::OnWorldPostActorTick.Remove(PostHandle);
+		PostHandle.Reset();
+	}
+
+	void OnPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+	{
+		if (InWorld != World.Get()) {
+			return;
+		}
+		//GGameThreadTime은 지난 프레임의 게임 스레드 시간이다. 물리 대기 시간도 들어 있다
+		const double FrameTime = FPlatformTime::ToMilliseconds(GGameThreadTime);
+		TotalTime += FrameTime;
+		MaxTime = FMath::Max(MaxTime, FrameTime);
+
+		const ANSRagdollBudget* Budget = ANSRagdollBudget::Get(InWorld);
+		const int32 NumRagdolls = Budget ? Budget->GetNumActive() : 0;
+		TotalRagdolls += NumRagdolls;
+		MaxRagdolls = FMath::Max(MaxRagdolls, NumRagdolls);
+		MaxBodies = FMath::Max(MaxBodies, Budget ? Budget->GetNumActiveBodies() : 0);
+
+		int32 NumSimulatingMeshes = 0;
+		for (TActorIterator<ANSCharacter> Iter(InWorld); Iter; ++Iter) {
+			NumSimulatingMeshes += Iter->GetMesh()->IsSimulatingPhysics() ? 1 : 0;
+		}
+		MaxSimulatingMeshes = FMath::Max(MaxSimulatingMeshes, NumSimulatingMeshes);
+
+		Frames++;
+		if (--FramesLeft <= 0) {
+			UE_LOG(LogTemp, Display, TEXT("ns.RagdollCost (%s): game thread avg %.3f ms, max %.3f ms over %d frames; ragdolls avg %.1f, max %d (%d bodies); character meshes simulating physics max %d"),
+				InWorld->GetNetMode() == NM_Client ? TEXT("client") : TEXT("server"), TotalTime / Frames, MaxTime, Frames,
+				(float)TotalRagdolls / Frames, MaxRagdolls, MaxBodies, MaxSimulatingMeshes);
+			Stop();
+		}
+	}
+};
+
+static FNSRagdollCostTimer GNSRagdollCostTimer;
+
+static FAutoConsoleCommandWithWorldAndArgs NSRagdollCostCommand(
+	TEXT("ns.RagdollCost"),
+	TEXT("Logs game thread time, simulating ragdolls and character meshes simulating physics over the next Frames. Run it on the server and on a client across ns.MassKill; on the server add 'stat physics' for the physics step breakdown. Args: [Frames=300]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) {
+			return;
+		}
+		GNSRagdollCostTimer.Start(World, FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300, 1));
+	})
+);
+#endif
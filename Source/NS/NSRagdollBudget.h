@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NSRagdollBudget.generated.h"
+
+class ANSCharacter;
+
+/**
+ * 클라이언트마다 하나씩 있는 래그돌 예산.
+ * 사망 물리는 보기 위한 것이라 클라이언트에서만 돌린다. 데디케이티드 서버에서는 만들지 않는다.
+ * 동시에 시뮬레이션하는 래그돌 수를 제한하고, 먼 사망은 래그돌 대신 사망 몽타주로 처리한다.
+ * 멈춘 래그돌은 시뮬레이션과 충돌을 꺼서 고정하고 예산에서 뺀다.
+ */
+UCLASS(config=Game)
+class NS_API ANSRagdollBudget : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSRagdollBudget();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** 월드의 래그돌 예산을 얻는다. 없으면 만든다. 데디케이티드 서버에서는 nullptr */
+	static ANSRagdollBudget* Get(const UObject* WorldContextObject);
+
+	/**
+	 * 래그돌을 켜도 되는지 묻고, 된다면 예산에 넣는다.
+	 * 예산이 차 있으면 가장 오래된 래그돌을 고정해서 자리를 만든다.
+	 * @return false면 몽타주로 대신한다
+	 */
+	bool RequestRagdoll(ANSCharacter* Character);
+
+	/** 리스폰이나 제거로 래그돌이 끝났을 때 */
+	void Release(ANSCharacter* Character);
+
+	/** 지금 시뮬레이션 중인 래그돌 수와 그 바디 수 */
+	int32 GetNumActive() const { return ActiveRagdolls.Num(); }
+	int32 GetNumActiveBodies() const;
+
+	/** 동시에 시뮬레이션할 최대 래그돌 수 */
+	UPROPERTY(config, EditAnywhere, Category = Ragdoll)
+	int32 MaxRagdolls;
+
+	/** 이 거리보다 먼 사망은 몽타주로 처리한다 */
+	UPROPERTY(config, EditAnywhere, Category = Ragdoll)
+	float RagdollDistance;
+
+	/** 루트 바디 속도가 이보다 느린 상태로 SettleTime 동안 있으면 고정한다 */
+	UPROPERTY(config, EditAnywhere, Category = Ragdoll)
+	float SettleSpeed;
+
+	UPROPERTY(config, EditAnywhere, Category = Ragdoll)
+	float SettleTime;
+
+	/** 멈추지 않아도 이 시간이 지나면 고정한다 */
+	UPROPERTY(config, EditAnywhere, Category = Ragdoll)
+	float MaxRagdollTime;
+
+private:
+	struct FActiveRagdoll
+	{
+		TWeakObjectPtr<ANSCharacter> Character;
+		float StartTime;
+		float SettleStartTime;
+	};
+
+	/** 시뮬레이션과 충돌을 끄고 포즈 갱신을 멈춘다. 리스폰 대기를 시작할 때 MultiCastBeginRespawnWait가 되돌린다 */
+	static void Freeze(ANSCharacter* Character);
+
+	/** 시작한 순서(오래된 것이 앞) */
+	TArray<FActiveRagdoll> ActiveRagdolls;
+};
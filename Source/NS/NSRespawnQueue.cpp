@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSRespawnQueue.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "NSTelemetry.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Respawn Queue Length"), STAT_NSRespawnQueueLength, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Respawn Attempts"), STAT_NSRespawnAttempts, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Respawns Forced"), STAT_NSRespawnsForced, STATGROUP_NS);
+
+FNSRespawnQueue::FNSRespawnQueue()
+	: RetryDelay(0.1f)
+	, MaxAttemptsBeforeForce(20)
+	, SequenceCounter(0)
+	, MaxWaitTime(0.0f)
+{
+	Heap.Reserve(64);
+	Pending.Reserve(64);
+}
+
+bool FNSRespawnQueue::Enqueue(ANSCharacter* Character, float ReadyTime)
+{
+	if (Character == nullptr || Pending.Contains(Character)) {
+		return false;
+	}
+
+	FEntry Entry;
+	Entry.Character = Character;
+	Entry.WeakCharacter = Character;
+	Entry.ReadyTime = ReadyTime;
+	Entry.EnqueueTime = ReadyTime;
+	Entry.Sequence = SequenceCounter++;
+	Entry.Attempts = 0;
+
+	Pending.Add(Character, Entry.Sequence);
+	Heap.HeapPush(Entry);
+	SET_DWORD_STAT(STAT_NSRespawnQueueLength, Pending.Num());
+	return true;
+}
+
+void FNSRespawnQueue::Cancel(ANSCharacter* Character)
+{
+	//힙에 남은 항목은 꺼낼 때 시퀀스가 맞지 않아 버려진다
+	Pending.Remove(Character);
+	SET_DWORD_STAT(STAT_NSRespawnQueueLength, Pending.Num());
+}
+
+int32 FNSRespawnQueue::Process(float Now, int32 MaxAttempts, TFunctionRef<bool(ANSCharacter*, bool)> TrySpawn)
+{
+	int32 NumSpawned = 0;
+	int32 NumAttempts = 0;
+
+	//실패한 항목은 이번 프레임이 끝난 뒤에 다시 넣어서 같은 프레임에 또 시도하지 않는다
+	TArray<FEntry, TInlineAllocator<16>> Retry;
+
+	while (Heap.Num() > 0 && NumAttempts < MaxAttempts && Heap.HeapTop().ReadyTime <= Now) {
+		FEntry Entry;
+		Heap.HeapPop(Entry, false);
+
+		const uint32* Sequence = Pending.Find(Entry.Character);
+		if (Sequence == nullptr || *Sequence != Entry.Sequence) {
+			continue;
+		}
+		if (!Entry.WeakCharacter.IsValid()) {
+			Pending.Remove(Entry.Character);
+			continue;
+		}
+
+		NumAttempts++;
+		INC_DWORD_STAT(STAT_NSRespawnAttempts);
+
+		const bool bForce = Entry.Attempts >= MaxAttemptsBeforeForce;
+		if (TrySpawn(Entry.Character, bForce)) {
+			if (bForce) {
+				INC_DWORD_STAT(STAT_NSRespawnsForced);
+			}
+			Pending.Remove(Entry.Character);
+			MaxWaitTime = FMath::Max(MaxWaitTime, Now - Entry.EnqueueTime);
+			FNSTelemetry::Record(ENSTelemetryEvent::RespawnWait, FNSTelemetry::GetPlayerId(Entry.Character), -1, FVector::ZeroVector, Now - Entry.EnqueueTime, (uint16)FMath::Min(Entry.Attempts, 0xFFFF));
+			NumSpawned++;
+		}
+		else {
+			Entry.Attempts++;
+			Entry.ReadyTime = Now + RetryDelay;
+			Retry.Add(Entry);
+		}
+	}
+
+	for (const FEntry& Entry : Retry) {
+		Heap.HeapPush(Entry);
+	}
+
+	SET_DWORD_STAT(STAT_NSRespawnQueueLength, Pending.Num());
+	return NumSpawned;
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+class ANSCharacter;
+
+/**
+ * 스폰을 기다리는 캐릭터 큐.
+ * (준비 시각, 들어온 순서)를 키로 하는 힙이라 먼저 준비된 캐릭터부터 시도한다.
+ * 포함 여부는 맵으로 확인하고, 취소된 항목은 꺼낼 때 버린다.
+ * 스폰에 실패하면 RetryDelay 뒤로 다시 넣고, MaxAttemptsBeforeForce번 실패하면 막혀 있어도 강제로 스폰시켜
+ * 아무도 무한정 기다리지 않는다.
+ */
+class NS_API FNSRespawnQueue
+{
+public:
+	FNSRespawnQueue();
+
+	/** ReadyTime 이후에 스폰을 시도한다. 이미 큐에 있으면 false */
+	bool Enqueue(ANSCharacter* Character, float ReadyTime);
+
+	/** 큐에서 뺀다 */
+	void Cancel(ANSCharacter* Character);
+
+	bool Contains(ANSCharacter* Character) const { return Pending.Contains(Character); }
+	int32 Num() const { return Pending.Num(); }
+
+	/** 가장 먼저 준비되는 항목의 시각. 취소된 항목일 수도 있어서 실제보다 이를 수 있다 */
+	float GetNextReadyTime() const { return Heap.Num() > 0 ? Heap[0].ReadyTime : 0.0f; }
+
+	/**
+	 * 준비된 캐릭터를 최대 MaxAttempts번 스폰 시도한다.
+	 * TrySpawn(Character, bForce)가 true를 돌려주면 큐에서 빠진다. bForce면 막혀 있어도 스폰해 보고, 그래도 실패하면 false를 돌려줘 큐에 남긴다
+	 * @return 이번에 스폰된 수
+	 */
+	int32 Process(float Now, int32 MaxAttempts, TFunctionRef<bool(ANSCharacter*, bool)> TrySpawn);
+
+	/** 지금까지 스폰된 캐릭터 중 가장 오래 기다린 시간(초) */
+	float GetMaxWaitTime() const { return MaxWaitTime; }
+	void ResetMaxWaitTime() { MaxWaitTime = 0.0f; }
+
+	/** 실패한 캐릭터를 다시 시도하기까지의 시간(초) */
+	float RetryDelay;
+
+	/** 이 횟수만큼 실패하면 강제로 스폰한다 */
+	int32 MaxAttemptsBeforeForce;
+
+private:
+	struct FEntry
+	{
+		ANSCharacter* Character;
+		TWeakObjectPtr<ANSCharacter> WeakCharacter;
+		float ReadyTime;
+		float EnqueueTime;
+		uint32 Sequence;
+		int32 Attempts;
+
+		bool operator<(const FEntry& Other) const
+		{
+			return ReadyTime < Other.ReadyTime || (ReadyTime == Other.ReadyTime && Sequence < Other.Sequence);
+		}
+	};
+
+	TArray<FEntry> Heap;
+
+	/** 큐에 있는 캐릭터와 그 항목의 시퀀스. 시퀀스가 다르면 힙의 항목은 취소된 것이다 */
+	TMap<ANSCharacter*, uint32> Pending;
+
+	uint32 SequenceCounter;
+	float MaxWaitTime;
+};
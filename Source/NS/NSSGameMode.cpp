@@ -7,19 +7,58 @@
 #include "NS.h"
 #include "NSPlayerState.h"
 #include "NSSpawnPoint.h"
-#include "EngineUtils.h"
 #include "NSGameState.h"
+#include "NSProjectile.h"
+#include "NSProjectilePool.h"
+#include "NSShotResolver.h"
+#include "NSLoadTestRecorder.h"
+#include "NSTelemetry.h"
+#include "NSCsvProfiler.h"
+#include "GameFramework/DamageType.h"
+#include "UObject/Package.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+#include "UObject/UObjectIterator.h"
 
-bool ANSSGameMode::bInGameMenu = true;
+DECLARE_CYCLE_STAT(TEXT("Respawn"), STAT_NSRespawn, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Spawn Queue Process"), STAT_NSSpawnQueueProcess, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Respawn Pawns Spawned"), STAT_NSRespawnPawnsSpawned, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Respawn Pawns Recycled"), STAT_NSRespawnPawnsRecycled, STATGROUP_NS);
 
 ANSSGameMode::ANSSGameMode()
 	: Super()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	//스폰 재시도와 단계 전환은 타이머로 한다. AGameMode의 틱 기반 매치 상태 전환도 쓰지 않고
+	//StartMatch/EndMatch를 직접 부르므로 게임 모드는 틱하지 않는다
+	PrimaryActorTick.bCanEverTick = false;
 
 	// set default pawn class to our Blueprinted character
 	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPersonCPP/Blueprints/FirstPersonCharacter"));
 	DefaultPawnClass = PlayerPawnClassFinder.Class;
+
+	static ConstructorHelpers::FClassFinder<ANSProjectile> ProjectileClassFinder(TEXT("/Game/FirstPersonCPP/Blueprints/FirstPersonProjectile"));
+	ProjectileClass = ProjectileClassFinder.Class ? ProjectileClassFinder.Class : ANSProjectile::StaticClass();
+	ProjectilePool = nullptr;
+	ShotResolver = nullptr;
+
+	bRecyclePawnsOnRespawn = true;
+	MaxSpawnAttemptsPerTick = 8;
+	SpawnAttemptFrame = 0;
+	SpawnAttemptsThisFrame = 0;
+	StressStartTime = 0.0;
+	StressFrames = 0;
+	StressMaxProcessTime = 0.0;
+
+	LobbyMap = TEXT("/Game/FirstPersonCPP/Maps/MenuMap");
+	MatchMap = TEXT("/Game/FirstPersonCPP/Maps/FirstPersonExampleMap");
+	WarmupDuration = 10.0f;
+	MatchDuration = 600.0f;
+	PostMatchDuration = 10.0f;
+
+	//맵이 바뀌어도 연결을 끊지 않는다. 짧은 전환 맵은 DefaultEngine.ini의 TransitionMap
+	bUseSeamlessTravel = true;
+
 	PlayerStateClass = ANSPlayerState::StaticClass();
 
 	// use our custom HUD class
@@ -34,87 +73,261 @@ void ANSSGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 	if (Role == ROLE_Authority) {
-		for (TActorIterator<ANSSpawnPoint>Iter(GetWorld()); Iter; ++Iter) {
-			if ((*Iter)->Team == ETeam::RED_TEAM) {
-				RedSpawn.Add(*Iter);
-			}
-			else {
-				BlueSpawn.Add(*Iter);
-			}
+		//발사체 풀을 만들고 미리 채워 둔다
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		ProjectilePool = GetWorld()->SpawnActor<ANSProjectilePool>(SpawnParams);
+		if (ProjectilePool) {
+			ProjectilePool->Prewarm(ProjectileClass, ProjectilePool->PrewarmCount);
 		}
-		// 
-		APlayerController* thisCont = GetWorld()->GetFirstPlayerController();
-		if (thisCont) {
-			ANSCharacter* thisChar = Cast<ANSCharacter>(thisCont->GetPawn());
-			thisChar->SetTeam(ETeam::BLUE_TEAM);
-			BlueTeam.Add(thisChar);
-			Spawn(thisChar);
+
+		//히트스캔 판정은 프레임 단위로 모아서 처리한다
+		ShotResolver = GetWorld()->SpawnActor<ANSShotResolver>(SpawnParams);
+
+		//-NSLoadTestCsv로 실행한 서버는 부하 측정 결과를 CSV로 남긴다
+		ANSLoadTestRecorder::StartIfRequested(GetWorld());
+
+		//-NSTelemetry로 실행한 서버는 매치 이벤트를 바이너리 로그로 남긴다
+		FNSTelemetry::StartIfRequested();
+
+		//-NSCsvProfile=<경로>로 실행한 서버는 프레임별 카테고리 시간을 CSV로 남긴다
+		FNSCsvProfiler::StartIfRequested();
+
+		SetMatchPhase(IsLobbyMap() ? ENSMatchPhase::Lobby : ENSMatchPhase::Warmup);
+
+		//게임 모드 틱으로 매치를 시작하지 않고 여기서 직접 시작한다. 심리스 트래블로 넘어온 플레이어까지
+		//HandleSeamlessTravelPlayer를 거친 뒤 HandleMatchHasStarted가 모두에게 RestartPlayer를 부른다.
+		//월드 BeginPlay 도중이라 다음 틱으로 미룬다
+		GetWorldTimerManager().SetTimerForNextTick(this, &ANSSGameMode::StartMatch);
+		UpdateShotTraceDrawing();
+	}
+}
+
+void ANSSGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(DrawShotTracesHandle);
+	DrawShotTracesHandle.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ANSSGameMode::UpdateShotTraceDrawing()
+{
+	const bool bDraw = FNSShotTraceLog::IsEnabled() && Role == ROLE_Authority;
+	if (bDraw && !DrawShotTracesHandle.IsValid()) {
+		DrawShotTracesHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ANSSGameMode::DrawShotTraces);
+	}
+	else if (!bDraw && DrawShotTracesHandle.IsValid()) {
+		FWorldDelegates::OnWorldPostActorTick.Remove(DrawShotTracesHandle);
+		DrawShotTracesHandle.Reset();
+	}
+}
+
+void ANSSGameMode::DrawShotTraces(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	//모든 월드의 틱에서 불리므로 내 월드만 그린다
+	if (World == GetWorld()) {
+		ShotTraceLog.Draw(World);
+	}
+}
+
+void ANSSGameMode::PostLogin(APlayerController * NewPlayer)
+{
+	//매치 중에 들어오면 Super에서 바로 RestartPlayer가 불리므로 팀을 먼저 정한다
+	AssignTeam(NewPlayer);
+	Super::PostLogin(NewPlayer);
+}
+
+void ANSSGameMode::HandleSeamlessTravelPlayer(AController*& C)
+{
+	//PostLogin을 거치지 않는다. 폰은 매치가 시작될 때 RestartPlayer에서 생긴다
+	Super::HandleSeamlessTravelPlayer(C);
+
+	APlayerController* thisPC = Cast<APlayerController>(C);
+	if (thisPC) {
+		AssignTeam(thisPC);
+		ANSCharacter* thisChar = Cast<ANSCharacter>(thisPC->GetPawn());
+		if (thisChar) {
+			SetupCharacter(thisChar);
 		}
-		Cast<ANSGameState>(GameState)->bInMenu = bInGameMenu;
 	}
 }
 
-void ANSSGameMode::Tick(float DeltaSeconds)
+void ANSSGameMode::RestartPlayer(AController* NewPlayer)
 {
-	if (Role == ROLE_Authority) {
-		APlayerController* thisCont = GetWorld()->GetFirstPlayerController();
-		if (ToBeSpawned.Num() != 0) {
-			for (auto charToSpawn : ToBeSpawned) {
-				Spawn(charToSpawn);
+	Super::RestartPlayer(NewPlayer);
+
+	ANSCharacter* thisChar = NewPlayer ? Cast<ANSCharacter>(NewPlayer->GetPawn()) : nullptr;
+	if (thisChar) {
+		SetupCharacter(thisChar);
+	}
+}
+
+void ANSSGameMode::AssignTeam(APlayerController* PC)
+{
+	ANSPlayerState* NPlayerState = PC ? Cast<ANSPlayerState>(PC->PlayerState) : nullptr;
+	if (Role != ROLE_Authority || NPlayerState == nullptr || GameState == nullptr) {
+		return;
+	}
+
+	//팀은 플레이어 상태 기준으로 센다. 폰이 아직 없는 플레이어도 포함된다
+	int32 BlueCount = 0;
+	int32 RedCount = 0;
+	for (APlayerState* Player : GameState->PlayerArray) {
+		ANSPlayerState* thisPS = Cast<ANSPlayerState>(Player);
+		if (thisPS && thisPS != NPlayerState) {
+			if (thisPS->GetTeam() == ETeam::BLUE_TEAM) {
+				BlueCount++;
+			}
+			else {
+				RedCount++;
 			}
 		}
+	}
 
-		if (thisCont != nullptr&&thisCont->IsInputKeyDown(EKeys::R)) {
-			bInGameMenu = false;
-			GetWorld()->ServerTravel(L"/Game/FirstPersonCPP/Maps/FirstPersonExampleMap?Listen");
-			Cast<ANSGameState>(GameState)->bInMenu = bInGameMenu;
-		}
+	//새 플레이어는 블루 팀이 기본값이므로 예전처럼 블루가 많을 때만 레드로 간다
+	const ETeam Preferred = NPlayerState->GetTeam();
+	const int32 PreferredCount = Preferred == ETeam::BLUE_TEAM ? BlueCount : RedCount;
+	const int32 OtherCount = Preferred == ETeam::BLUE_TEAM ? RedCount : BlueCount;
+	const ETeam NewTeam = PreferredCount > OtherCount ? (Preferred == ETeam::BLUE_TEAM ? ETeam::RED_TEAM : ETeam::BLUE_TEAM) : Preferred;
+	NPlayerState->SetTeam(NewTeam);
+}
+
+void ANSSGameMode::SetupCharacter(ANSCharacter* Character)
+{
+	ANSPlayerState* thisPS = Cast<ANSPlayerState>(Character->PlayerState);
+	if (thisPS == nullptr) {
+		return;
 	}
+	Character->SetNSPlayerState(thisPS);
+	Character->CurrentTeam = thisPS->GetTeam();
+	Character->SetTeam(thisPS->GetTeam());
+	Spawn(Character);
 }
 
-void ANSSGameMode::PostLogin(APlayerController * NewPlayer)
+bool ANSSGameMode::IsLobbyMap() const
 {
-	Super::PostLogin(NewPlayer);
+	return UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()) == LobbyMap;
+}
 
-	ANSCharacter* Teamless = Cast<ANSCharacter>(NewPlayer->GetPawn());
-	ANSPlayerState* NPlayerState = Cast<ANSPlayerState>(NewPlayer->PlayerState);
+ENSMatchPhase ANSSGameMode::GetMatchPhase() const
+{
+	const ANSGameState* thisGameState = GetGameState<ANSGameState>();
+	return thisGameState ? thisGameState->MatchPhase : ENSMatchPhase::Lobby;
+}
 
-	if (Teamless != nullptr&&NPlayerState != nullptr) {
-		Teamless->SetNSPlayerState(NPlayerState);
+void ANSSGameMode::SetMatchPhase(ENSMatchPhase NewPhase)
+{
+	ANSGameState* thisGameState = GetGameState<ANSGameState>();
+	if (thisGameState == nullptr) {
+		return;
+	}
+
+	float Duration = 0.0f;
+	switch (NewPhase) {
+	case ENSMatchPhase::Warmup:
+		Duration = WarmupDuration;
+		break;
+	case ENSMatchPhase::Live:
+		Duration = MatchDuration;
+		break;
+	case ENSMatchPhase::Post:
+		Duration = PostMatchDuration;
+		break;
+	default:
+		break;
 	}
-	//   
 
-	if (Role == ROLE_Authority && Teamless != nullptr) {
-		if (BlueTeam.Num() > RedTeam.Num()) {
-			RedTeam.Add(Teamless);
-			NPlayerState->Team = ETeam::RED_TEAM;
+	thisGameState->MatchPhase = NewPhase;
+	thisGameState->PhaseEndTime = Duration > 0.0f ? GetWorld()->GetTimeSeconds() + Duration : 0.0f;
+	thisGameState->ForceNetUpdate();
+
+	GetWorldTimerManager().ClearTimer(MatchPhaseTimer);
+	if (Duration > 0.0f) {
+		GetWorldTimerManager().SetTimer(MatchPhaseTimer, this, &ANSSGameMode::AdvanceMatchPhase, Duration, false);
+	}
+}
+
+void ANSSGameMode::AdvanceMatchPhase()
+{
+	switch (GetMatchPhase()) {
+	case ENSMatchPhase::Warmup:
+		SetMatchPhase(ENSMatchPhase::Live);
+		StartLive();
+		break;
+	case ENSMatchPhase::Live:
+		SetMatchPhase(ENSMatchPhase::Post);
+		EndMatch();
+		break;
+	case ENSMatchPhase::Post:
+		//매치가 끝나면 로비로 돌아간다. 연결은 그대로 유지된다
+		TravelTo(LobbyMap);
+		break;
+	default:
+		break;
+	}
+}
+
+void ANSSGameMode::StartLive()
+{
+	for (FConstPlayerControllerIterator Iter = GetWorld()->GetPlayerControllerIterator(); Iter; ++Iter) {
+		APlayerController* thisPC = Iter->Get();
+		if (thisPC == nullptr) {
+			continue;
 		}
-		else if (BlueTeam.Num() < RedTeam.Num()) {
-			BlueTeam.Add(Teamless);
-			NPlayerState->Team = ETeam::BLUE_TEAM;
+		ANSPlayerState* thisPS = Cast<ANSPlayerState>(thisPC->PlayerState);
+		if (thisPS) {
+			thisPS->ResetMatchStats();
 		}
-		else//  
-		{
-			BlueTeam.Add(Teamless);
-			NPlayerState->Team = ETeam::BLUE_TEAM;
+		//죽어 있는 폰은 자기 리스폰 타이머로 돌아온다
+		ANSCharacter* thisChar = Cast<ANSCharacter>(thisPC->GetPawn());
+		if (thisChar && !thisChar->IsDying()) {
+			thisChar->Respawn();
 		}
-
-		Teamless->CurrentTeam = NPlayerState->Team;
-		Teamless->SetTeam(NPlayerState->Team);
-		Spawn(Teamless);
 	}
 }
 
-void ANSSGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+void ANSSGameMode::TravelToMatch()
+{
+	TravelTo(MatchMap);
+}
+
+void ANSSGameMode::TravelTo(const FString& Map)
+{
+	//단일 프로세스 PIE는 심리스 트래블을 지원하지 않아서 에디터에서는 일반 트래블로 간다
+	bUseSeamlessTravel = GetWorld()->WorldType != EWorldType::PIE;
+	GetWorld()->ServerTravel(Map + TEXT("?Listen"));
+}
+
+void ANSSGameMode::RegisterSpawnPoint(ANSSpawnPoint* SpawnPoint)
 {
-	if (EndPlayReason == EEndPlayReason::Quit || EndPlayReason == EEndPlayReason::EndPlayInEditor) {
-		bInGameMenu = true;
+	if (SpawnPoint->Team == ETeam::RED_TEAM) {
+		RedSpawn.AddUnique(SpawnPoint);
+	}
+	else {
+		BlueSpawn.AddUnique(SpawnPoint);
 	}
 }
 
-void ANSSGameMode::Respawn(ANSCharacter * Character)
+void ANSSGameMode::UnregisterSpawnPoint(ANSSpawnPoint* SpawnPoint)
 {
+	RedSpawn.RemoveSwap(SpawnPoint);
+	BlueSpawn.RemoveSwap(SpawnPoint);
+}
+
+bool ANSSGameMode::Respawn(ANSCharacter * Character)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSRespawn);
+	NS_CSV_SCOPE(Spawning);
 	if (Role == ROLE_Authority) {
+		if (bRecyclePawnsOnRespawn) {
+			//죽은 폰을 숨겨 두었다가 스폰 지점이 나면 옮겨서 되살린다
+			INC_DWORD_STAT(STAT_NSRespawnPawnsRecycled);
+			Character->BeginRespawnWait();
+			Spawn(Character);
+			return true;
+		}
+
+		INC_DWORD_STAT(STAT_NSRespawnPawnsSpawned);
 		AController* thisPC = Character->GetController();
 		Character->DetachFromControllerPendingDestroy();
 
@@ -124,47 +337,221 @@ void ANSSGameMode::Respawn(ANSCharacter * Character)
 			thisPC->Possess(newChar);
 			ANSPlayerState* thisPS = Cast<ANSPlayerState>(newChar->GetController()->PlayerState);
 
-			newChar->CurrentTeam = thisPS->Team;
+			newChar->CurrentTeam = thisPS->GetTeam();
 			newChar->SetNSPlayerState(thisPS);
 
+			//기본 위치에서 맞거나 보이지 않도록 스폰 지점이 날 때까지 숨긴다
+			newChar->BeginRespawnWait();
 			Spawn(newChar);
 
-			newChar->SetTeam(newChar->GetNSPlayerState()->Team);
+			newChar->SetTeam(newChar->GetNSPlayerState()->GetTeam());
 
 		}
 	}
+	return false;
+}
+
+void ANSSGameMode::RecordDeath(const FVector& Location)
+{
+	SpawnSelector.RecordDeath(Location, GetWorld()->GetTimeSeconds());
 }
 
 void ANSSGameMode::Spawn(ANSCharacter * Character)
 {
 	if (Role == ROLE_Authority) {
-		ANSSpawnPoint* thisSpawn = nullptr;
-		TArray<ANSSpawnPoint*>* targetTeam = nullptr;
-		if (Character->CurrentTeam == ETeam::BLUE_TEAM) {
-			targetTeam = &BlueSpawn;
-		}
-		else {
-			targetTeam = &RedSpawn;
+		SpawnQueue.Enqueue(Character, GetWorld()->GetTimeSeconds());
+		ProcessSpawnQueue();
+	}
+}
+
+void ANSSGameMode::CancelSpawn(ANSCharacter * Character)
+{
+	SpawnQueue.Cancel(Character);
+}
+
+void ANSSGameMode::ProcessSpawnQueue()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSSpawnQueueProcess);
+	NS_CSV_SCOPE(Spawning);
+	const double ProcessStartTime = FPlatformTime::Seconds();
+	if (SpawnAttemptFrame != GFrameCounter) {
+		SpawnAttemptFrame = GFrameCounter;
+		SpawnAttemptsThisFrame = 0;
+		if (StressCharacters.Num() != 0) {
+			StressFrames++;
 		}
+	}
 
-		for (auto Spawn : (*targetTeam)) {
-			if (!Spawn->GetBlcoked()) {
-				// ť ġ 
-				if (ToBeSpawned.Find(Character) != INDEX_NONE) {
-					ToBeSpawned.Remove(Character);
+	const int32 MaxAttempts = MaxSpawnAttemptsPerTick - SpawnAttemptsThisFrame;
+	if (MaxAttempts > 0 && SpawnQueue.Num() != 0) {
+		SpawnQueue.Process(GetWorld()->GetTimeSeconds(), MaxAttempts, [this](ANSCharacter* Character, bool bForce)
+		{
+			SpawnAttemptsThisFrame++;
+			return TrySpawn(Character, bForce);
+		});
+	}
+
+	//남은 캐릭터가 준비되는 시각에 다시 부른다. 이번 프레임 시도 횟수를 다 썼으면 다음 프레임이 된다
+	if (SpawnQueue.Num() != 0) {
+		const float Delay = SpawnQueue.GetNextReadyTime() - GetWorld()->GetTimeSeconds();
+		GetWorldTimerManager().SetTimer(SpawnQueueTimer, this, &ANSSGameMode::ProcessSpawnQueue, FMath::Max(Delay, KINDA_SMALL_NUMBER), false);
+	}
+	else {
+		GetWorldTimerManager().ClearTimer(SpawnQueueTimer);
+	}
+
+	if (StressCharacters.Num() != 0) {
+		StressMaxProcessTime = FMath::Max(StressMaxProcessTime, FPlatformTime::Seconds() - ProcessStartTime);
+		if (SpawnQueue.Num() == 0) {
+			UE_LOG(LogTemp, Display, TEXT("Respawn stress: %d characters in %.2f ms over %d frames, max queue time/frame %.3f ms, max wait %.2f s"),
+				StressCharacters.Num(), (FPlatformTime::Seconds() - StressStartTime) * 1000.0, StressFrames,
+				StressMaxProcessTime * 1000.0, SpawnQueue.GetMaxWaitTime());
+			for (ANSCharacter* thisChar : StressCharacters) {
+				if (thisChar) {
+					thisChar->Destroy();
 				}
-				//׷   ġ 
-				Character->SetActorLocation(Spawn->GetActorLocation());
-				Spawn->UpdateOverlaps();
-				return;
 			}
+			StressCharacters.Reset();
+		}
+	}
+}
+
+void ANSSGameMode::RequestStartMatch(APlayerController* Requester)
+{
+	//리슨 서버 호스트만 매치를 시작할 수 있다
+	if (Requester == nullptr || !Requester->IsLocalController() || GetMatchPhase() != ENSMatchPhase::Lobby) {
+		return;
+	}
+	TravelToMatch();
+}
+
+bool ANSSGameMode::TrySpawn(ANSCharacter * Character, bool bForce)
+{
+	TArray<ANSSpawnPoint*>* targetTeam = nullptr;
+	if (Character->CurrentTeam == ETeam::BLUE_TEAM) {
+		targetTeam = &BlueSpawn;
+	}
+	else {
+		targetTeam = &RedSpawn;
+	}
 
-			if (ToBeSpawned.Find(Character) == INDEX_NONE) {
-				ToBeSpawned.Add(Character);
+	//적과 최근 사망 위치에서 먼 빈 지점을 고른다
+	ANSSpawnPoint* thisSpawn = SpawnSelector.Select(GetWorld(), *targetTeam, Character->CurrentTeam, LagCompensation.GetCharacters());
+	if (thisSpawn) {
+		//이동하면서 오버랩 이벤트가 발생해 지점이 점유 상태가 되도록 서버에서는 충돌을 먼저 켠다
+		Character->SetActorEnableCollision(true);
+		Character->SetActorLocation(thisSpawn->GetActorLocation());
+		Character->FinishRespawn();
+		FNSTelemetry::Record(ENSTelemetryEvent::Spawn, FNSTelemetry::GetPlayerId(Character), -1, Character->GetActorLocation());
+		return true;
+	}
+
+	//너무 오래 기다렸으면 막혀 있어도 근처의 빈 곳으로 밀어 넣는다. 임의의 지점부터 돌며 순간이동이 되는 첫 곳을 쓴다
+	if (bForce) {
+		if (targetTeam->Num() == 0) {
+			UE_LOG(LogTemp, Error, TEXT("No spawn points for %s's team, keeping it queued"), *Character->GetName());
+			return false;
+		}
+		//순간이동은 충돌로 빈 곳을 찾으니 서버에서 충돌을 켜고 시도한다
+		Character->SetActorEnableCollision(true);
+		const int32 FirstIndex = FMath::RandHelper(targetTeam->Num());
+		for (int32 i = 0; i < targetTeam->Num(); i++) {
+			ANSSpawnPoint* forcedSpawn = (*targetTeam)[(FirstIndex + i) % targetTeam->Num()];
+			if (Character->TeleportTo(forcedSpawn->GetActorLocation(), Character->GetActorRotation())) {
+				Character->FinishRespawn();
+				FNSTelemetry::Record(ENSTelemetryEvent::Spawn, FNSTelemetry::GetPlayerId(Character), -1, Character->GetActorLocation(), 0.0f, 0, 1);
+				return true;
 			}
 		}
+		Character->SetActorEnableCollision(false);
+		UE_LOG(LogTemp, Warning, TEXT("Forced spawn of %s failed at every spawn point, retrying"), *Character->GetName());
+	}
+	return false;
+}
+
+void ANSSGameMode::StartRespawnStress(int32 Count)
+{
+	if (Role != ROLE_Authority || DefaultPawnClass == nullptr) {
+		return;
+	}
+
+	StressStartTime = FPlatformTime::Seconds();
+	StressFrames = 0;
+	StressMaxProcessTime = 0.0;
+	SpawnQueue.ResetMaxWaitTime();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < Count; i++) {
+		ANSCharacter* thisChar = GetWorld()->SpawnActor<ANSCharacter>(DefaultPawnClass, FVector(0.0f, 0.0f, -100000.0f), FRotator::ZeroRotator, SpawnParams);
+		if (thisChar) {
+			thisChar->CurrentTeam = (i % 2 == 0) ? ETeam::BLUE_TEAM : ETeam::RED_TEAM;
+			StressCharacters.Add(thisChar);
+		}
+	}
+	//라운드 시작처럼 모두 같은 프레임에 큐에 넣는다
+	for (ANSCharacter* thisChar : StressCharacters) {
+		Spawn(thisChar);
 	}
 }
 
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs NSRespawnStressCommand(
+	TEXT("ns.RespawnStress"),
+	TEXT("Queues Count bot characters for spawn in the same frame and logs how long the queue takes to drain. Args: [Count=200]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		ANSSGameMode* thisGameMode = World ? Cast<ANSSGameMode>(World->GetAuthGameMode()) : nullptr;
+		if (thisGameMode == nullptr) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.RespawnStress must run on the server"));
+			return;
+		}
+		thisGameMode->StartRespawnStress(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200);
+	})
+);
+
+static FAutoConsoleCommandWithWorldAndArgs NSMassKillCommand(
+	TEXT("ns.MassKill"),
+	TEXT("Kills up to Count living players in the same frame. Compare 'ns.RagdollCost' before and after on the server (with 'stat physics') and on a client. Args: [Count=all]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		ANSSGameMode* thisGameMode = World ? Cast<ANSSGameMode>(World->GetAuthGameMode()) : nullptr;
+		if (thisGameMode == nullptr) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.MassKill must run on the server"));
+			return;
+		}
+
+		const int32 MaxKills = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : MAX_int32;
+		int32 NumKilled = 0;
+		//죽으면서 목록이 바뀌지 않도록 복사해서 돈다
+		const TArray<ANSCharacter*> Characters = thisGameMode->GetLagCompensation().GetCharacters();
+		for (ANSCharacter* thisChar : Characters) {
+			if (NumKilled >= MaxKills) {
+				break;
+			}
+			ANSPlayerState* thisPS = thisChar->GetNSPlayerState();
+			if (thisPS == nullptr || thisPS->GetHealth() <= 0) {
+				continue;
+			}
+			FDamageEvent thisEvent(UDamageType::StaticClass());
+			thisChar->TakeDamage(thisPS->GetHealth(), thisEvent, nullptr, nullptr);
+			NumKilled++;
+		}
+		UE_LOG(LogTemp, Display, TEXT("ns.MassKill: killed %d players"), NumKilled);
+	})
+);
+
+//ns.DebugShots를 바꾸면 선을 그리는 델리게이트만 붙이거나 뗀다. 게임 모드 틱과는 상관없다
+static void NSUpdateShotTraceDrawing()
+{
+	for (TObjectIterator<ANSSGameMode> Iter; Iter; ++Iter) {
+		if (Iter->GetWorld() && Iter->HasActorBegunPlay() && !Iter->IsPendingKill()) {
+			Iter->UpdateShotTraceDrawing();
+		}
+	}
+}
 
+static FAutoConsoleVariableSink NSShotTraceDrawingSink(FConsoleCommandDelegate::CreateStatic(&NSUpdateShotTraceDrawing));
 
+#endif
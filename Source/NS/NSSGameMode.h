@@ -4,16 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameMode.h"
+#include "NSLagCompensation.h"
+#include "NSSpawnSelector.h"
+#include "NSRespawnQueue.h"
+#include "NSShotTraceLog.h"
+#include "NSGameState.h"
 #include "NSSGameMode.generated.h"
 
 UENUM(BlueprintType)
 enum class ETeam : uint8 {
 	BLUE_TEAM,
-	RED_TEAM
+	RED_TEAM,
+
+	TEAM_COUNT UMETA(Hidden)
 };
 
 /**
- * 
+ * 로비와 매치 맵이 함께 쓰는 게임 모드.
+ * 로비 맵에서는 Lobby 단계에 머물고, 매치 맵에서는 Warmup -> Live -> Post를 타이머로 넘긴다.
+ * 맵 사이는 심리스 트래블로 옮겨서 연결과 플레이어 상태를 유지한다.
  */
 UCLASS(minimalapi)
 class ANSSGameMode : public AGameMode
@@ -23,23 +32,134 @@ class ANSSGameMode : public AGameMode
 public:
 	ANSSGameMode();
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
-	virtual void PostLogin(APlayerController* NewPlayer) override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void PostLogin(APlayerController* NewPlayer) override;
+	virtual void HandleSeamlessTravelPlayer(AController*& C) override;
+
+	/** 새 폰에 플레이어 상태의 팀을 입히고 스폰 지점으로 보낸다 */
+	virtual void RestartPlayer(AController* NewPlayer) override;
+
+	/** 로비에서 매치 맵으로 심리스 트래블한다 */
+	void TravelToMatch();
+
+	/** StartMatch 입력으로 들어온 시작 요청. 로비 단계의 호스트 요청만 받는다 */
+	void RequestStartMatch(APlayerController* Requester);
+
+	ENSMatchPhase GetMatchPhase() const;
+
+	/** 스폰 지점이 BeginPlay/EndPlay에서 직접 등록한다 */
+	void RegisterSpawnPoint(class ANSSpawnPoint* SpawnPoint);
+	void UnregisterSpawnPoint(class ANSSpawnPoint* SpawnPoint);
+
+	/** 캐릭터를 리스폰한다. 죽은 폰을 재사용했으면 true, 새 폰을 만들었으면 false */
+	bool Respawn(class ANSCharacter* Character);
 
-	void Respawn(class ANSCharacter* Character);
+	/** 스폰 큐에 넣고, 이번 프레임 시도 횟수가 남아 있으면 바로 시도한다 */
 	void Spawn(class ANSCharacter* Character);
 
-private:
-	TArray<class ANSCharacter*> RedTeam;
-	TArray<class ANSCharacter*> BlueTeam;
+	/** 스폰 큐에서 뺀다 */
+	void CancelSpawn(class ANSCharacter* Character);
+
+	/** 캐릭터 Count개를 한꺼번에 스폰 큐에 넣고 모두 스폰될 때까지 걸린 시간을 로그로 남긴다 */
+	void StartRespawnStress(int32 Count);
+
+	/** 사망 위치를 스폰 선택기에 알린다. 최근 사망이 많은 지점은 피해서 스폰한다 */
+	void RecordDeath(const FVector& Location);
+
+	FNSLagCompensation& GetLagCompensation() { return LagCompensation; }
+	FNSShotTraceLog& GetShotTraceLog() { return ShotTraceLog; }
+
+	/** ns.DebugShots가 켜져 있는 동안만 월드 틱 뒤에 트레이스 기록을 그리도록 등록하거나 푼다 */
+	void UpdateShotTraceDrawing();
+	class ANSProjectilePool* GetProjectilePool() const { return ProjectilePool; }
+	class ANSShotResolver* GetShotResolver() const { return ShotResolver; }
+	TSubclassOf<class ANSProjectile> GetProjectileClass() const { return ProjectileClass; }
+
+protected:
+	/** 리스폰 때 새 폰을 스폰하지 않고 죽은 폰을 되살려 재사용할지 여부 */
+	UPROPERTY(config, EditDefaultsOnly, Category = Respawn)
+	bool bRecyclePawnsOnRespawn;
+
+	/** 맵 로드 때 풀에 미리 만들어 둘 발사체 클래스 */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	TSubclassOf<class ANSProjectile> ProjectileClass;
+
+	/** 한 프레임에 시도할 최대 스폰 수 */
+	UPROPERTY(config, EditDefaultsOnly, Category = Respawn)
+	int32 MaxSpawnAttemptsPerTick;
+
+	/** 로비 맵과 매치 맵의 패키지 경로 */
+	UPROPERTY(config, EditDefaultsOnly, Category = Match)
+	FString LobbyMap;
 
+	UPROPERTY(config, EditDefaultsOnly, Category = Match)
+	FString MatchMap;
+
+	/** 단계별 길이(초). 0이면 다음 단계로 넘어가지 않는다 */
+	UPROPERTY(config, EditDefaultsOnly, Category = Match)
+	float WarmupDuration;
+
+	UPROPERTY(config, EditDefaultsOnly, Category = Match)
+	float MatchDuration;
+
+	UPROPERTY(config, EditDefaultsOnly, Category = Match)
+	float PostMatchDuration;
+
+private:
 	TArray<class ANSSpawnPoint*> RedSpawn;
 	TArray<class ANSSpawnPoint*> BlueSpawn;
-	TArray<class ANSCharacter*> ToBeSpawned;
 
-	bool bGameStarted;
-	static bool bInGameMenu;
+	/**
+	 * 플레이어 상태에 팀을 정한다. 폰이 없어도 되므로 RestartPlayer 전에 부른다.
+	 * 인원이 적은 팀에 넣고, 트래블로 넘어온 팀은 균형이 맞으면 유지한다
+	 */
+	void AssignTeam(APlayerController* PC);
+
+	/** 폰에 플레이어 상태와 팀 색을 입히고 스폰 큐에 넣는다 */
+	void SetupCharacter(class ANSCharacter* Character);
+
+	bool IsLobbyMap() const;
+
+	/** 단계를 바꾸고 길이가 있으면 다음 단계로 넘기는 타이머를 건다 */
+	void SetMatchPhase(ENSMatchPhase NewPhase);
+	void AdvanceMatchPhase();
+
+	/** 워밍업 기록을 지우고 모두 스폰 지점으로 보낸다 */
+	void StartLive();
+
+	void TravelTo(const FString& Map);
+
+	FTimerHandle MatchPhaseTimer;
+
+	/** 준비된 캐릭터를 이번 프레임에 남은 횟수만큼 스폰한다 */
+	void ProcessSpawnQueue();
+	bool TrySpawn(class ANSCharacter* Character, bool bForce);
+
+	FNSRespawnQueue SpawnQueue;
+	FTimerHandle SpawnQueueTimer;
+	uint64 SpawnAttemptFrame;
+	int32 SpawnAttemptsThisFrame;
+
+	FNSLagCompensation LagCompensation;
+	FNSSpawnSelector SpawnSelector;
+	FNSShotTraceLog ShotTraceLog;
+
+	/** 액터 틱이 끝난 뒤 트레이스 기록을 그린다. 게임 모드 자체는 틱하지 않는다 */
+	void DrawShotTraces(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	FDelegateHandle DrawShotTracesHandle;
+
+	UPROPERTY()
+	class ANSProjectilePool* ProjectilePool;
+
+	UPROPERTY()
+	class ANSShotResolver* ShotResolver;
+
+	/** 리스폰 스트레스 테스트 상태 */
+	UPROPERTY()
+	TArray<class ANSCharacter*> StressCharacters;
+	double StressStartTime;
+	int32 StressFrames;
+	double StressMaxProcessTime;
 	
 	
 };
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSScoreboard.h"
+#include "NSPlayerState.h"
+
+FNSScoreboard::FNSScoreboard()
+	: Revision(0)
+{
+	//128명 서버에서도 한쪽 팀이 다 차기 전에는 다시 할당하지 않는다
+	for (TArray<FNSScoreboardRow>& Rows : Teams) {
+		Rows.Reserve(64);
+	}
+	Slots.Reserve(128);
+}
+
+void FNSScoreboard::Add(ANSPlayerState* PlayerState)
+{
+	if (PlayerState == nullptr) {
+		return;
+	}
+	if (Slots.Contains(PlayerState)) {
+		Update(PlayerState);
+		return;
+	}
+
+	const int32 TeamIndex = (int32)PlayerState->GetTeam();
+	if (!ensure(TeamIndex < NumTeams)) {
+		return;
+	}
+	TArray<FNSScoreboardRow>& Rows = Teams[TeamIndex];
+	const int32 Index = Rows.AddDefaulted();
+	FNSScoreboardRow& Row = Rows[Index];
+	Row.PlayerState = PlayerState;
+	Row.Key = PlayerState;
+	Row.Name = PlayerState->GetPlayerName();
+	Row.Score = PlayerState->Score;
+	Row.PlayerId = PlayerState->PlayerId;
+	Row.Deaths = PlayerState->GetDeaths();
+	Row.Health = (uint8)FMath::CeilToInt(PlayerState->GetHealth());
+	Slots.Add(PlayerState, FSlot{ TeamIndex, Index });
+	Place(TeamIndex, Index);
+	Revision++;
+}
+
+void FNSScoreboard::Remove(ANSPlayerState* PlayerState)
+{
+	const FSlot* Slot = Slots.Find(PlayerState);
+	if (Slot) {
+		RemoveAt(Slot->Team, Slot->Index);
+		Revision++;
+	}
+}
+
+void FNSScoreboard::Update(ANSPlayerState* PlayerState)
+{
+	const FSlot* Slot = PlayerState ? Slots.Find(PlayerState) : nullptr;
+	if (Slot == nullptr) {
+		return;
+	}
+	const int32 TeamIndex = Slot->Team;
+	const int32 Index = Slot->Index;
+
+	//팀이 바뀌었으면 원래 팀에서 빼고 새 팀에 다시 넣는다
+	if (TeamIndex != (int32)PlayerState->GetTeam()) {
+		RemoveAt(TeamIndex, Index);
+		Add(PlayerState);
+		return;
+	}
+
+	FNSScoreboardRow& Row = Teams[TeamIndex][Index];
+	const uint8 Health = (uint8)FMath::CeilToInt(PlayerState->GetHealth());
+	const FString& Name = PlayerState->GetPlayerName();
+	if (Row.Score == PlayerState->Score && Row.Deaths == PlayerState->GetDeaths() && Row.Health == Health
+		&& Row.PlayerId == PlayerState->PlayerId && Row.Name.Equals(Name, ESearchCase::CaseSensitive)) {
+		return;
+	}
+	if (!Row.Name.Equals(Name, ESearchCase::CaseSensitive)) {
+		Row.Name = Name;
+	}
+	Row.Score = PlayerState->Score;
+	Row.PlayerId = PlayerState->PlayerId;
+	Row.Deaths = PlayerState->GetDeaths();
+	Row.Health = Health;
+	Place(TeamIndex, Index);
+	Revision++;
+}
+
+void FNSScoreboard::RemoveAt(int32 TeamIndex, int32 Index)
+{
+	TArray<FNSScoreboardRow>& Rows = Teams[TeamIndex];
+	Slots.Remove(Rows[Index].Key);
+	Rows.RemoveAt(Index, 1, false);
+	//나가거나 팀을 옮길 때만 불리니 뒤쪽 줄 번호를 당기는 비용은 괜찮다
+	for (int32 i = Index; i < Rows.Num(); i++) {
+		Slots.FindChecked(Rows[i].Key).Index = i;
+	}
+}
+
+void FNSScoreboard::Place(int32 TeamIndex, int32 Index)
+{
+	//점수는 한 번에 조금씩 바뀌므로 이웃과 자리를 바꾸는 삽입 정렬 한 단계로 충분하다
+	TArray<FNSScoreboardRow>& Rows = Teams[TeamIndex];
+	while (Index > 0 && IsBefore(Rows[Index], Rows[Index - 1])) {
+		SwapRows(TeamIndex, Index, Index - 1);
+		Index--;
+	}
+	while (Index < Rows.Num() - 1 && IsBefore(Rows[Index + 1], Rows[Index])) {
+		SwapRows(TeamIndex, Index, Index + 1);
+		Index++;
+	}
+}
+
+void FNSScoreboard::SwapRows(int32 TeamIndex, int32 A, int32 B)
+{
+	TArray<FNSScoreboardRow>& Rows = Teams[TeamIndex];
+	Rows.Swap(A, B);
+	Slots.FindChecked(Rows[A].Key).Index = A;
+	Slots.FindChecked(Rows[B].Key).Index = B;
+}
+
+bool FNSScoreboard::IsBefore(const FNSScoreboardRow& A, const FNSScoreboardRow& B)
+{
+	if (A.Score != B.Score) {
+		return A.Score > B.Score;
+	}
+	if (A.Deaths != B.Deaths) {
+		return A.Deaths < B.Deaths;
+	}
+	return A.PlayerId < B.PlayerId;
+}
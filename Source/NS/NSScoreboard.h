@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "NSSGameMode.h"
+class ANSPlayerState;
+
+/** 스코어보드 한 줄. 플레이어 상태에서 복사해 둔 표시 값 */
+struct FNSScoreboardRow
+{
+	TWeakObjectPtr<ANSPlayerState> PlayerState;
+
+	/** 스코어보드가 줄을 찾을 때 쓰는 키. 플레이어 상태가 지워지는 중에도 남아 있도록 따로 들고 역참조하지 않는다 */
+	const ANSPlayerState* Key;
+	FString Name;
+	float Score;
+	int32 PlayerId;
+	uint8 Deaths;
+
+	/** 체력은 소유자에게만 복제되므로 클라이언트에서는 자기 줄만 정확하다 */
+	uint8 Health;
+};
+
+/**
+ * 팀별로 정렬된 플레이어 명단.
+ * 게임 상태가 들고 있고, 플레이어가 들어오고 나갈 때와 플레이어 상태의 OnRep(서버는 세터)에서만 갱신된다.
+ * 바뀐 줄 하나만 제자리로 옮기므로 매 프레임 PlayerArray를 돌며 캐스트할 필요가 없다.
+ * 플레이어 상태마다 팀과 줄 번호를 맵에 들고 있어서 갱신할 때 명단을 찾아 돌지 않는다.
+ * 정렬 순서는 점수 내림차순, 데스 오름차순, PlayerId 순이다.
+ */
+class NS_API FNSScoreboard
+{
+public:
+	enum { NumTeams = (int32)ETeam::TEAM_COUNT };
+
+	FNSScoreboard();
+
+	/** 들어온 플레이어를 추가한다. 이미 있으면 Update와 같다 */
+	void Add(ANSPlayerState* PlayerState);
+	void Remove(ANSPlayerState* PlayerState);
+
+	/** 플레이어 상태의 값을 다시 읽어 줄을 고치고 팀 안에서 제자리로 옮긴다 */
+	void Update(ANSPlayerState* PlayerState);
+
+	const TArray<FNSScoreboardRow>& GetTeam(ETeam Team) const { return Teams[(uint8)Team]; }
+	int32 Num() const { return Slots.Num(); }
+
+	/** 줄이 추가, 삭제, 수정, 이동될 때마다 올라간다. HUD는 이 값이 같으면 명단을 다시 그리지 않는다 */
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	/** 플레이어 상태의 줄이 있는 곳 */
+	struct FSlot
+	{
+		int32 Team;
+		int32 Index;
+	};
+
+	/** 팀 줄 목록에서 한 줄을 빼고 그 뒤 줄들의 번호를 당긴다 */
+	void RemoveAt(int32 TeamIndex, int32 Index);
+
+	/** 값이 바뀐 줄 하나를 이웃과 비교해 정렬된 위치로 옮기고, 자리가 바뀐 줄들의 번호를 고친다 */
+	void Place(int32 TeamIndex, int32 Index);
+	void SwapRows(int32 TeamIndex, int32 A, int32 B);
+
+	static bool IsBefore(const FNSScoreboardRow& A, const FNSScoreboardRow& B);
+
+	TArray<FNSScoreboardRow> Teams[NumTeams];
+
+	/** 키는 비교에만 쓰고 역참조하지 않는다. 줄이 지워질 때 같이 지운다 */
+	TMap<const ANSPlayerState*, FSlot> Slots;
+	uint32 Revision;
+};
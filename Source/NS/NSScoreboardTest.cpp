@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSScoreboard.h"
+#include "NSPlayerState.h"
+#include "NS.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** 팀 명단의 PlayerId를 위에서부터 늘어놓는다 */
+	FString GetOrder(const FNSScoreboard& Scoreboard, ETeam Team)
+	{
+		FString Order;
+		for (const FNSScoreboardRow& Row : Scoreboard.GetTeam(Team)) {
+			Order += FString::Printf(Order.IsEmpty() ? TEXT("%d") : TEXT(",%d"), Row.PlayerId);
+		}
+		return Order;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSScoreboardOrderTest, "NS.Scoreboard.Order", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNSScoreboardOrderTest::RunTest(const FString& Parameters)
+{
+	//게임 상태가 없는 월드라 플레이어 상태의 세터가 명단을 건드리지 않고, 여기서 직접 Add와 Update를 부른다
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+
+	FNSScoreboard Scoreboard;
+	TArray<ANSPlayerState*> PlayerStates;
+	for (int32 i = 0; i < 5; i++) {
+		ANSPlayerState* PlayerState = World->SpawnActor<ANSPlayerState>();
+		PlayerState->PlayerId = i;
+		PlayerState->SetTeam(ETeam::BLUE_TEAM);
+		PlayerStates.Add(PlayerState);
+	}
+
+	//점수 내림차순, 데스 오름차순, PlayerId 순
+	PlayerStates[0]->AddScore(10.0f);
+	PlayerStates[1]->AddScore(20.0f);
+	PlayerStates[2]->AddScore(20.0f);
+	PlayerStates[2]->AddDeath();
+	PlayerStates[3]->AddScore(20.0f);
+	for (ANSPlayerState* PlayerState : PlayerStates) {
+		Scoreboard.Add(PlayerState);
+	}
+	TestEqual(TEXT("Initial order"), GetOrder(Scoreboard, ETeam::BLUE_TEAM), FString(TEXT("1,3,2,0,4")));
+	TestEqual(TEXT("Row count"), Scoreboard.Num(), 5);
+
+	//바뀐 줄만 제자리로 옮긴다
+	PlayerStates[4]->AddScore(15.0f);
+	Scoreboard.Update(PlayerStates[4]);
+	TestEqual(TEXT("Order after a score change"), GetOrder(Scoreboard, ETeam::BLUE_TEAM), FString(TEXT("1,3,2,4,0")));
+	PlayerStates[1]->AddDeath();
+	PlayerStates[1]->AddDeath();
+	Scoreboard.Update(PlayerStates[1]);
+	TestEqual(TEXT("Order after a death"), GetOrder(Scoreboard, ETeam::BLUE_TEAM), FString(TEXT("3,2,1,4,0")));
+
+	//값이 같으면 리비전이 오르지 않는다
+	const uint32 Revision = Scoreboard.GetRevision();
+	Scoreboard.Update(PlayerStates[2]);
+	TestTrue(TEXT("Unchanged update keeps the revision"), Scoreboard.GetRevision() == Revision);
+
+	//팀을 옮기면 원래 팀에서 빠지고 새 팀에 정렬되어 들어간다
+	PlayerStates[2]->SetTeam(ETeam::RED_TEAM);
+	Scoreboard.Update(PlayerStates[2]);
+	PlayerStates[0]->SetTeam(ETeam::RED_TEAM);
+	Scoreboard.Update(PlayerStates[0]);
+	TestEqual(TEXT("Blue order after team moves"), GetOrder(Scoreboard, ETeam::BLUE_TEAM), FString(TEXT("3,1,4")));
+	TestEqual(TEXT("Red order after team moves"), GetOrder(Scoreboard, ETeam::RED_TEAM), FString(TEXT("2,0")));
+	TestEqual(TEXT("Row count after team moves"), Scoreboard.Num(), 5);
+
+	//지운 줄 뒤의 줄들도 계속 찾아서 고칠 수 있어야 한다
+	Scoreboard.Remove(PlayerStates[3]);
+	PlayerStates[4]->AddScore(100.0f);
+	Scoreboard.Update(PlayerStates[4]);
+	TestEqual(TEXT("Blue order after a removal"), GetOrder(Scoreboard, ETeam::BLUE_TEAM), FString(TEXT("4,1")));
+	TestEqual(TEXT("Row count after a removal"), Scoreboard.Num(), 4);
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
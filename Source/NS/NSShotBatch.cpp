@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSShotBatch.h"
+#include "UObject/CoreNet.h"
+#include "HAL/IConsoleManager.h"
+
+const int32 FNSShotBatch::MaxShots;
+const int32 FNSShotBatch::MaxWindowMs;
+
+uint32 FNSPackedShot::EncodeDirection(const FVector& Dir)
+{
+	//팔면체에 투영한 뒤 아래쪽 반은 위로 접는다
+	const float L1 = FMath::Abs(Dir.X) + FMath::Abs(Dir.Y) + FMath::Abs(Dir.Z);
+	float X = L1 > SMALL_NUMBER ? Dir.X / L1 : 0.0f;
+	float Y = L1 > SMALL_NUMBER ? Dir.Y / L1 : 0.0f;
+	if (Dir.Z < 0.0f) {
+		const float FoldX = (1.0f - FMath::Abs(Y)) * (X >= 0.0f ? 1.0f : -1.0f);
+		const float FoldY = (1.0f - FMath::Abs(X)) * (Y >= 0.0f ? 1.0f : -1.0f);
+		X = FoldX;
+		Y = FoldY;
+	}
+
+	const uint32 U = (uint32)FMath::RoundToInt((X * 0.5f + 0.5f) * 65535.0f);
+	const uint32 V = (uint32)FMath::RoundToInt((Y * 0.5f + 0.5f) * 65535.0f);
+	return (U << 16) | (V & 0xFFFF);
+}
+
+FVector FNSPackedShot::DecodeDirection(uint32 Packed)
+{
+	float X = ((Packed >> 16) / 65535.0f) * 2.0f - 1.0f;
+	float Y = ((Packed & 0xFFFF) / 65535.0f) * 2.0f - 1.0f;
+	const float Z = 1.0f - FMath::Abs(X) - FMath::Abs(Y);
+	const float T = FMath::Max(-Z, 0.0f);
+	X += X >= 0.0f ? -T : T;
+	Y += Y >= 0.0f ? -T : T;
+	return FVector(X, Y, Z).GetSafeNormal();
+}
+
+bool FNSShotBatch::AddShot(uint16 ShotId, const FVector& Origin, const FVector& Dir, float ShotTime)
+{
+	if (Shots.Num() == 0) {
+		BaseTime = ShotTime;
+		FirstShotId = ShotId;
+	}
+
+	const int32 OffsetMs = FMath::RoundToInt((ShotTime - BaseTime) * 1000.0f);
+	if (Shots.Num() >= MaxShots || OffsetMs > MaxWindowMs) {
+		return false;
+	}
+
+	FNSPackedShot& Shot = Shots[Shots.AddDefaulted()];
+	Shot.Origin = Origin;
+	Shot.Direction = FNSPackedShot::EncodeDirection(Dir);
+	Shot.TimeOffset = (uint8)FMath::Max(OffsetMs, 0);
+	return true;
+}
+
+void FNSShotBatch::Reset()
+{
+	BaseTime = 0.0f;
+	Shots.Reset();
+}
+
+bool FNSShotBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	Ar << BaseTime;
+	Ar << FirstShotId;
+
+	uint32 NumShots = Shots.Num();
+	Ar.SerializeInt(NumShots, MaxShots + 1);
+	if (Ar.IsLoading()) {
+		Shots.SetNum(NumShots);
+	}
+
+	for (FNSPackedShot& Shot : Shots) {
+		bool bShotSuccess = true;
+		Shot.Origin.NetSerialize(Ar, Map, bShotSuccess);
+		Ar << Shot.Direction;
+		Ar << Shot.TimeOffset;
+		bOutSuccess &= bShotSuccess;
+	}
+	return true;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * 600 RPM 자동 사격 기준으로 기존 ServerFire 경로와 배치 경로의 플레이어당 상향 대역폭을 비교한다.
+ * 페이로드는 실제 직렬화 결과를 재고, RPC/번치 헤더는 추정치를 더한다.
+ */
+static FAutoConsoleCommand NSFireBandwidthReportCommand(
+	TEXT("ns.FireBandwidthReport"),
+	TEXT("Compares per-player upstream bytes/s of single ServerFire RPCs against batched shots at 600 RPM. Optional arg: shots per batch (capped by the batch time window)."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const float ShotsPerSecond = 600.0f / 60.0f;
+		const int32 RpcOverheadBits = 64;
+		const int32 ShotsPerBatch = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, FNSShotBatch::MaxShots) : 3;
+
+		const FVector Origin(1234.5f, -2345.25f, 180.0f);
+		const FVector Dir = FVector(0.8f, 0.55f, -0.1f).GetSafeNormal();
+
+		//기존 경로: 정밀도 그대로의 FVector 두 개(예측용 ID와 시각이 없던 때)
+		FNetBitWriter OldWriter(nullptr, 1024);
+		FVector OldPos = Origin;
+		FVector OldDir = Dir * 10000000.0f;
+		OldWriter << OldPos;
+		OldWriter << OldDir;
+		const float OldBitsPerShot = OldWriter.GetNumBits() + RpcOverheadBits;
+
+		FNSShotBatch Batch;
+		for (int32 i = 0; i < ShotsPerBatch; i++) {
+			Batch.AddShot(i, Origin + FVector(i * 10.0f, 0.0f, 0.0f), Dir, i / ShotsPerSecond);
+		}
+		FNetBitWriter NewWriter(nullptr, 1024);
+		bool bSuccess = true;
+		Batch.NetSerialize(NewWriter, nullptr, bSuccess);
+		const float NewBitsPerShot = (NewWriter.GetNumBits() + RpcOverheadBits) / (float)Batch.Shots.Num();
+
+		const FVector Decoded = FNSPackedShot::DecodeDirection(Batch.Shots[0].Direction);
+		UE_LOG(LogTemp, Display, TEXT("ServerFire:      %.1f bits/shot, %.1f bytes/s per player"), OldBitsPerShot, OldBitsPerShot * ShotsPerSecond / 8.0f);
+		UE_LOG(LogTemp, Display, TEXT("ServerFireBatch: %.1f bits/shot, %.1f bytes/s per player (%d shots/batch)"), NewBitsPerShot, NewBitsPerShot * ShotsPerSecond / 8.0f, Batch.Shots.Num());
+		UE_LOG(LogTemp, Display, TEXT("Direction error: %.4f deg"), FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector::DotProduct(Dir, Decoded), -1.0f, 1.0f))));
+	})
+);
+
+#endif
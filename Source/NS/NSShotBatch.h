@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "NSShotBatch.generated.h"
+
+/** 배치 안의 한 발. 방향은 옥타헤드럴 인코딩된 단위 벡터(16+16비트) */
+USTRUCT()
+struct FNSPackedShot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	uint32 Direction;
+
+	/** 배치 기준 시각으로부터의 오프셋(ms) */
+	UPROPERTY()
+	uint8 TimeOffset;
+
+	FNSPackedShot()
+		: Origin(ForceInit)
+		, Direction(0)
+		, TimeOffset(0)
+	{
+	}
+
+	static uint32 EncodeDirection(const FVector& Dir);
+	static FVector DecodeDirection(uint32 Packed);
+};
+
+/** 자동 사격 시 여러 프레임의 발사를 한 번의 RPC로 묶어 보내는 배치 */
+USTRUCT()
+struct FNSShotBatch
+{
+	GENERATED_BODY()
+
+	/** 한 배치에 담을 수 있는 최대 발 수 */
+	static const int32 MaxShots = 16;
+
+	/** 한 배치가 묶을 수 있는 최대 시간 폭(ms). TimeOffset이 uint8에 들어가야 한다 */
+	static const int32 MaxWindowMs = 250;
+
+	/** 첫 발의 서버 기준 시각 */
+	UPROPERTY()
+	float BaseTime;
+
+	/** 첫 발의 시퀀스 ID. 이후 발들은 1씩 증가한다 */
+	UPROPERTY()
+	uint16 FirstShotId;
+
+	UPROPERTY()
+	TArray<FNSPackedShot> Shots;
+
+	FNSShotBatch()
+		: BaseTime(0.0f)
+		, FirstShotId(0)
+	{
+	}
+
+	/** 발사를 추가한다. 시간 폭이나 개수를 넘으면 false */
+	bool AddShot(uint16 ShotId, const FVector& Origin, const FVector& Dir, float ShotTime);
+
+	void Reset();
+
+	FVector GetDirection(int32 Index) const { return FNSPackedShot::DecodeDirection(Shots[Index].Direction); }
+	float GetShotTime(int32 Index) const { return BaseTime + Shots[Index].TimeOffset * 0.001f; }
+	uint16 GetShotId(int32 Index) const { return FirstShotId + Index; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FNSShotBatch> : public TStructOpsTypeTraitsBase2<FNSShotBatch>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSShotPrediction.h"
+
+FNSShotPrediction::FNSShotPrediction()
+	: Head(0)
+	, ShotIdCounter(0)
+{
+	for (FNSPredictedHit& Hit : Hits) {
+		Hit.ShotId = 0;
+		Hit.State = FNSPredictedHit::Rejected;
+		Hit.Time = -BIG_NUMBER;
+		Hit.Location = FVector::ZeroVector;
+	}
+}
+
+void FNSShotPrediction::AddPredictedHit(uint16 ShotId, const FVector& Location, float Time)
+{
+	FNSPredictedHit& Hit = Hits[Head];
+	Hit.ShotId = ShotId;
+	Hit.State = FNSPredictedHit::Pending;
+	Hit.Time = Time;
+	Hit.Location = Location;
+	Head = (Head + 1) % Capacity;
+}
+
+FNSPredictedHit* FNSShotPrediction::Find(uint16 ShotId)
+{
+	for (FNSPredictedHit& Hit : Hits) {
+		if (Hit.ShotId == ShotId && Hit.State == FNSPredictedHit::Pending) {
+			return &Hit;
+		}
+	}
+	return nullptr;
+}
+
+int32 FNSShotPrediction::Reconcile(uint16 FirstShotId, uint8 Count, uint16 ConfirmMask, float Time)
+{
+	int32 NumUnpredicted = 0;
+	for (int32 i = 0; i < Count; i++) {
+		const uint16 ShotId = FirstShotId + i;
+		const bool bConfirmed = (ConfirmMask & (1 << i)) != 0;
+
+		FNSPredictedHit* Hit = Find(ShotId);
+		if (Hit) {
+			//서버가 인정하지 않은 히트는 마커에서 뺀다
+			Hit->State = bConfirmed ? FNSPredictedHit::Confirmed : FNSPredictedHit::Rejected;
+		}
+		else if (bConfirmed) {
+			//예측은 빗나갔지만 서버에서는 맞았다. 늦게라도 마커를 보여준다
+			AddPredictedHit(ShotId, FVector::ZeroVector, Time);
+			Hits[(Head + Capacity - 1) % Capacity].State = FNSPredictedHit::Confirmed;
+			NumUnpredicted++;
+		}
+	}
+	return NumUnpredicted;
+}
+
+bool FNSShotPrediction::HasActiveHitMarker(float Now, float Duration) const
+{
+	for (const FNSPredictedHit& Hit : Hits) {
+		if (Hit.State != FNSPredictedHit::Rejected && Now - Hit.Time < Duration) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 클라이언트가 예측한 히트 하나 */
+struct FNSPredictedHit
+{
+	enum EState : uint8
+	{
+		Pending,
+		Confirmed,
+		Rejected
+	};
+
+	uint16 ShotId;
+	EState State;
+	float Time;
+	FVector Location;
+};
+
+/**
+ * 소유 클라이언트 쪽의 발사 예측 상태.
+ * 발사마다 시퀀스 ID를 붙이고, 예측한 히트를 고정 크기 링 버퍼에 기록해 두었다가
+ * 서버의 확인(ack)이 오면 확정하거나 되돌린다.
+ */
+class NS_API FNSShotPrediction
+{
+public:
+	enum { Capacity = 32 };
+
+	FNSShotPrediction();
+
+	/** 다음 발사에 쓸 시퀀스 ID를 발급한다 */
+	uint16 NextShotId() { return ShotIdCounter++; }
+
+	void AddPredictedHit(uint16 ShotId, const FVector& Location, float Time);
+
+	/**
+	 * 서버 ack를 반영한다. FirstShotId부터 Count발에 대해 ConfirmMask 비트가 켜진 발만 서버가 히트로 인정했다.
+	 * @return 예측하지 못했는데 서버가 히트로 인정한 발 수
+	 */
+	int32 Reconcile(uint16 FirstShotId, uint8 Count, uint16 ConfirmMask, float Time);
+
+	/** 되돌려지지 않은 히트 중 Duration 안에 있는 것이 있으면 히트 마커를 그린다 */
+	bool HasActiveHitMarker(float Now, float Duration) const;
+
+private:
+	FNSPredictedHit* Find(uint16 ShotId);
+
+	FNSPredictedHit Hits[Capacity];
+	int32 Head;
+	uint16 ShotIdCounter;
+};
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSShotResolver.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "NSPlayerState.h"
+#include "NSSGameMode.h"
+#include "NSTelemetry.h"
+#include "NSCsvProfiler.h"
+#include "Engine/World.h"
+#include "GameFramework/DamageType.h"
+#include "NSTickAudit.h"
+
+DECLARE_CYCLE_STAT(TEXT("Shot Queue"), STAT_NSShotQueue, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Shot Resolve"), STAT_NSShotResolve, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shots Resolved/Frame"), STAT_NSShotsResolved, STATGROUP_NS);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Shot Traces/Frame"), STAT_NSShotTraces, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Shot Trace Sync Fallbacks"), STAT_NSShotTraceFallbacks, STATGROUP_NS);
+
+ANSShotResolver::ANSShotResolver()
+{
+	//클라이언트 RPC는 월드 틱 전에 처리되므로 같은 프레임 틱 전에 들어온 발사도 다음 프레임에 판정된다
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+	bReplicates = false;
+
+	Queue.Reserve(256);
+	Resolving.Reserve(256);
+}
+
+void ANSShotResolver::QueueShot(ANSCharacter* Shooter, const FVector& pos, const FVector& dir, float ShotTime, uint16 ShotId, bool bValid)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSShotQueue);
+	NS_CSV_SCOPE(Shooting);
+
+	FQueuedShot& Shot = Queue[Queue.AddUninitialized()];
+	Shot.Shooter = Shooter;
+	Shot.Target = nullptr;
+	Shot.Zone = ENSHitZone::Body;
+	Shot.Start = pos;
+	Shot.End = pos + dir * Shooter->HitscanRange;
+	Shot.Frame = GFrameCounter;
+	Shot.ShotTime = ShotTime;
+	Shot.ShooterId = Shooter->PlayerState ? Shooter->PlayerState->PlayerId : 0;
+	Shot.ShotId = ShotId;
+	Shot.bValid = bValid;
+	Shot.bCandidate = false;
+	Shot.bHit = false;
+	FNSTelemetry::Record(ENSTelemetryEvent::Shot, Shot.ShooterId, -1, pos, 0.0f, ShotId, bValid ? 1 : 0);
+
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	if (bValid && thisGameMode) {
+		//되감은 히트박스 검사는 해석적이라 싸다. 맞은 발사만 월드 트레이스로 벽을 확인한다
+		const FNSLagCompensation& LagCompensation = thisGameMode->GetLagCompensation();
+		FNSRewindHit RewindHit;
+		if (LagCompensation.TraceRewound(Shot.Start, Shot.End, LagCompensation.ClampRewindTime(ShotTime, GetWorld()->GetTimeSeconds()), Shooter, RewindHit)) {
+			Shot.Target = RewindHit.Character;
+			Shot.Zone = RewindHit.Zone;
+			Shot.End = RewindHit.Location;
+			Shot.bCandidate = true;
+
+			FCollisionQueryParams ColQuery;
+			ColQuery.AddIgnoredActor(Shooter);
+			ColQuery.AddIgnoredActor(RewindHit.Character);
+			Shot.TraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Test, Shot.Start, Shot.End, ECC_Visibility, ColQuery);
+			INC_DWORD_STAT(STAT_NSShotTraces);
+		}
+	}
+
+	SetActorTickEnabled(true);
+}
+
+void ANSShotResolver::Tick(float DeltaSeconds)
+{
+	NS_TICK_AUDIT_SCOPE();
+	Super::Tick(DeltaSeconds);
+
+	Resolve();
+
+	if (Queue.Num() == 0) {
+		SetActorTickEnabled(false);
+	}
+}
+
+void ANSShotResolver::Resolve()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSShotResolve);
+	NS_CSV_SCOPE(Shooting);
+
+	//지난 프레임까지 들어온 발사만 꺼낸다. 이번 프레임 것은 트레이스가 아직 돌지 않았다
+	Resolving.Reset();
+	int32 NumReady = 0;
+	while (NumReady < Queue.Num() && Queue[NumReady].Frame < GFrameCounter) {
+		NumReady++;
+	}
+	if (NumReady == 0) {
+		return;
+	}
+	Resolving.Append(Queue.GetData(), NumReady);
+	Queue.RemoveAt(0, NumReady, false);
+
+	//도착 순서가 아니라 발사 시각, 플레이어, 시퀀스 순으로 적용해서 결과가 항상 같게 한다
+	Resolving.StableSort([](const FQueuedShot& A, const FQueuedShot& B)
+	{
+		if (A.ShotTime != B.ShotTime) {
+			return A.ShotTime < B.ShotTime;
+		}
+		if (A.ShooterId != B.ShooterId) {
+			return A.ShooterId < B.ShooterId;
+		}
+		return A.ShotId < B.ShotId;
+	});
+
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (FQueuedShot& Shot : Resolving) {
+		INC_DWORD_STAT(STAT_NSShotsResolved);
+
+		ANSCharacter* Shooter = Shot.Shooter.Get();
+		ANSPlayerState* ShooterPS = Shooter ? Shooter->GetNSPlayerState() : nullptr;
+		//같은 배치에서 먼저 죽었으면 무효
+		if (!Shot.bValid || ShooterPS == nullptr || ShooterPS->GetHealth() <= 0) {
+			continue;
+		}
+
+		if (!Shot.bCandidate) {
+			if (thisGameMode) {
+				thisGameMode->GetShotTraceLog().Record(Now, Shot.Start, Shot.End, ENSShotTraceResult::Miss);
+			}
+			continue;
+		}
+
+		//벽 너머의 히트는 인정하지 않는다
+		FTraceDatum Datum;
+		bool bBlocked = false;
+		if (GetWorld()->QueryTraceData(Shot.TraceHandle, Datum)) {
+			bBlocked = Datum.OutHits.Num() > 0;
+		}
+		else {
+			//비동기 결과를 못 얻었으면(핸들이 오래됐거나 버퍼 프레임이 어긋남) 막히지 않은 것으로 보지 않고 지금 다시 트레이스한다
+			INC_DWORD_STAT(STAT_NSShotTraceFallbacks);
+			FCollisionQueryParams ColQuery;
+			ColQuery.AddIgnoredActor(Shooter);
+			ColQuery.AddIgnoredActor(Shot.Target.Get());
+			bBlocked = GetWorld()->LineTraceTestByChannel(Shot.Start, Shot.End, ECC_Visibility, ColQuery);
+		}
+		if (bBlocked) {
+			if (thisGameMode) {
+				thisGameMode->GetShotTraceLog().Record(Now, Shot.Start, Shot.End, ENSShotTraceResult::Blocked);
+			}
+			continue;
+		}
+
+		ANSCharacter* OtherChar = Shot.Target.Get();
+		ANSPlayerState* OtherPS = OtherChar ? OtherChar->GetNSPlayerState() : nullptr;
+		if (OtherPS != nullptr && OtherPS->GetTeam() != ShooterPS->GetTeam() && OtherPS->GetHealth() > 0) {
+			//히트 피드백은 클라이언트가 예측해서 재생하고 ack로 확정한다
+			FDamageEvent thisEvent(UDamageType::StaticClass());
+			OtherChar->TakeDamage(10.0f * OtherChar->GetDamageMultiplier(Shot.Zone), thisEvent, Shooter->GetController(), Shooter);
+			Shot.bHit = true;
+			if (thisGameMode) {
+				thisGameMode->GetShotTraceLog().Record(Now, Shot.Start, Shot.End, ENSShotTraceResult::Hit);
+			}
+		}
+	}
+
+	SendAcks();
+}
+
+void ANSShotResolver::SendAcks()
+{
+	//쏜 사람과 시퀀스 순으로 다시 정렬해서 연속된 발사를 ack 하나로 묶는다
+	Resolving.Sort([](const FQueuedShot& A, const FQueuedShot& B)
+	{
+		if (A.ShooterId != B.ShooterId) {
+			return A.ShooterId < B.ShooterId;
+		}
+		return A.ShotId < B.ShotId;
+	});
+
+	int32 Index = 0;
+	while (Index < Resolving.Num()) {
+		const FQueuedShot& First = Resolving[Index];
+		ANSCharacter* Shooter = First.Shooter.Get();
+
+		uint8 Count = 0;
+		uint16 ConfirmMask = 0;
+		while (Index < Resolving.Num() && Count < 16) {
+			const FQueuedShot& Shot = Resolving[Index];
+			if (Shot.Shooter != First.Shooter || Shot.ShotId != (uint16)(First.ShotId + Count)) {
+				break;
+			}
+			if (Shot.bHit) {
+				ConfirmMask |= 1 << Count;
+			}
+			Count++;
+			Index++;
+		}
+
+		if (Shooter) {
+			Shooter->ClientAckShots(First.ShotId, Count, ConfirmMask);
+		}
+	}
+}
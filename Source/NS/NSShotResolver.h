@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WorldCollision.h"
+#include "NSHitShapes.h"
+#include "NSShotResolver.generated.h"
+
+class ANSCharacter;
+
+/**
+ * 서버의 히트스캔 판정 큐.
+ * RPC 핸들러는 발사를 큐에 넣고 되감은 히트박스에 맞은 발사만 벽 검사용 비동기 트레이스를 요청한다.
+ * 트레이스는 프레임 끝에 한꺼번에 돌고, 다음 프레임 PrePhysics에서 발사 시각 순으로 피해를 적용한 뒤
+ * 쏜 사람마다 묶어서 ack를 보낸다. 큐가 비면 틱하지 않는다.
+ */
+UCLASS()
+class NS_API ANSShotResolver : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANSShotResolver();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/**
+	 * 발사 하나를 큐에 넣는다. bValid가 false면 트레이스 없이 실패로 ack만 보낸다.
+	 * dir은 단위 벡터
+	 */
+	void QueueShot(ANSCharacter* Shooter, const FVector& pos, const FVector& dir, float ShotTime, uint16 ShotId, bool bValid);
+
+private:
+	struct FQueuedShot
+	{
+		TWeakObjectPtr<ANSCharacter> Shooter;
+		TWeakObjectPtr<ANSCharacter> Target;
+		ENSHitZone Zone;
+		FVector Start;
+		FVector End;
+		FTraceHandle TraceHandle;
+		uint64 Frame;
+		float ShotTime;
+		int32 ShooterId;
+		uint16 ShotId;
+		bool bValid;
+		bool bCandidate;
+		bool bHit;
+	};
+
+	void Resolve();
+	void SendAcks();
+
+	/** 들어온 순서대로 쌓인 발사 */
+	TArray<FQueuedShot> Queue;
+
+	/** 이번 프레임에 처리할 발사. 재사용해서 할당하지 않는다 */
+	TArray<FQueuedShot> Resolving;
+};
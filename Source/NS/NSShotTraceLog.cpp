@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSShotTraceLog.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+#if !UE_BUILD_SHIPPING
+
+static TAutoConsoleVariable<int32> CVarNSDebugShots(
+	TEXT("ns.DebugShots"),
+	0,
+	TEXT("Draw the server's hit-registration traces. Green: hit, yellow: blocked by world, red: miss."));
+
+static TAutoConsoleVariable<int32> CVarNSDebugShotsCount(
+	TEXT("ns.DebugShots.Count"),
+	64,
+	TEXT("How many of the most recent traces to draw (max 256)."));
+
+static TAutoConsoleVariable<float> CVarNSDebugShotsLifetime(
+	TEXT("ns.DebugShots.Lifetime"),
+	5.0f,
+	TEXT("Seconds a trace stays visible."));
+
+static TAutoConsoleVariable<float> CVarNSDebugShotsLength(
+	TEXT("ns.DebugShots.Length"),
+	10000.0f,
+	TEXT("Misses are drawn at most this long."));
+
+#endif
+
+FNSShotTraceLog::FNSShotTraceLog()
+#if !UE_BUILD_SHIPPING
+	: Head(0)
+	, Count(0)
+#endif
+{
+}
+
+bool FNSShotTraceLog::IsEnabled()
+{
+#if !UE_BUILD_SHIPPING
+	return CVarNSDebugShots.GetValueOnGameThread() != 0;
+#else
+	return false;
+#endif
+}
+
+void FNSShotTraceLog::Record(float Time, const FVector& Start, const FVector& End, ENSShotTraceResult Result)
+{
+#if !UE_BUILD_SHIPPING
+	if (!IsEnabled()) {
+		return;
+	}
+
+	FTrace& Trace = Traces[Head];
+	Trace.Start = Start;
+	Trace.End = Start + (End - Start).GetClampedToMaxSize(CVarNSDebugShotsLength.GetValueOnGameThread());
+	Trace.Time = Time;
+	Trace.Result = Result;
+
+	Head = (Head + 1) % Capacity;
+	Count = FMath::Min(Count + 1, (int32)Capacity);
+#endif
+}
+
+void FNSShotTraceLog::Draw(UWorld* World) const
+{
+#if !UE_BUILD_SHIPPING
+	if (!IsEnabled() || World == nullptr) {
+		return;
+	}
+
+	const float Now = World->GetTimeSeconds();
+	const float Lifetime = CVarNSDebugShotsLifetime.GetValueOnGameThread();
+	const int32 NumToDraw = FMath::Min(Count, FMath::Clamp(CVarNSDebugShotsCount.GetValueOnGameThread(), 0, (int32)Capacity));
+
+	//최신 것부터 그리다가 수명이 지난 기록을 만나면 멈춘다
+	for (int32 i = 0; i < NumToDraw; i++) {
+		const FTrace& Trace = Traces[(Head - 1 - i + Capacity) % Capacity];
+		if (Now - Trace.Time > Lifetime) {
+			break;
+		}
+
+		FColor Color = FColor::Red;
+		if (Trace.Result == ENSShotTraceResult::Hit) {
+			Color = FColor::Green;
+		}
+		else if (Trace.Result == ENSShotTraceResult::Blocked) {
+			Color = FColor::Yellow;
+		}
+		DrawDebugLine(World, Trace.Start, Trace.End, Color, false, -1.0f, 0, 2.0f);
+	}
+#endif
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 서버 판정 결과에 따른 트레이스 색 */
+enum class ENSShotTraceResult : uint8
+{
+	Miss,
+	Hit,
+	Blocked
+};
+
+/**
+ * 서버 히트 판정 디버그용 트레이스 기록.
+ * ns.DebugShots가 켜져 있을 때만 최근 N개를 고정 크기 링 버퍼에 남기고, 매 프레임 한 프레임짜리 선으로 다시 그린다.
+ * 영구 라인 배치를 쓰지 않으므로 긴 매치에서도 쌓이지 않는다. Shipping에서는 아무것도 하지 않는다.
+ */
+class NS_API FNSShotTraceLog
+{
+public:
+	enum { Capacity = 256 };
+
+	FNSShotTraceLog();
+
+	void Record(float Time, const FVector& Start, const FVector& End, ENSShotTraceResult Result);
+
+	/** 수명이 남은 트레이스를 그린다. 리슨 서버에서 매 프레임 호출 */
+	void Draw(UWorld* World) const;
+
+	static bool IsEnabled();
+
+private:
+	struct FTrace
+	{
+		FVector Start;
+		FVector End;
+		float Time;
+		ENSShotTraceResult Result;
+	};
+
+#if !UE_BUILD_SHIPPING
+	FTrace Traces[Capacity];
+	int32 Head;
+	int32 Count;
+#endif
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSShotValidation.h"
+#include "NS.h"
+#include "NSPlayerState.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Shots Rejected"), STAT_NSShotsRejected, STATGROUP_NS);
+
+FNSShotValidator::FNSShotValidator()
+	: Tokens(-1.0f)
+	, LastRefillTime(0.0f)
+	, Head(0)
+	, Count(0)
+	, TotalViolations(0)
+{
+}
+
+bool FNSShotValidator::ConsumeToken(float Now, float RatePerSecond, float Burst)
+{
+	//첫 발사는 꽉 찬 버킷에서 시작한다
+	if (Tokens < 0.0f) {
+		Tokens = Burst;
+	}
+	else {
+		Tokens = FMath::Min(Burst, Tokens + FMath::Max(Now - LastRefillTime, 0.0f) * RatePerSecond);
+	}
+	LastRefillTime = Now;
+
+	if (Tokens < 1.0f) {
+		return false;
+	}
+	Tokens -= 1.0f;
+	return true;
+}
+
+bool FNSShotValidator::IsValidDirection(const FVector& Dir, const FVector& AimDir, float MinAimDot)
+{
+	//양자화된 단위 벡터라 길이 오차가 약간 있다
+	const float SizeSquared = Dir.SizeSquared();
+	if (Dir.ContainsNaN() || SizeSquared < 0.96f || SizeSquared > 1.04f) {
+		return false;
+	}
+	return FVector::DotProduct(Dir, AimDir) >= MinAimDot * FMath::Sqrt(SizeSquared);
+}
+
+void FNSShotValidator::LogViolation(float Time, uint16 ShotId, ENSShotViolation Reason, float Value)
+{
+	FNSShotViolation& Violation = Violations[Head];
+	Violation.Time = Time;
+	Violation.Value = Value;
+	Violation.ShotId = ShotId;
+	Violation.Reason = Reason;
+
+	Head = (Head + 1) % LogCapacity;
+	Count = FMath::Min(Count + 1, (int32)LogCapacity);
+	TotalViolations++;
+	INC_DWORD_STAT(STAT_NSShotsRejected);
+}
+
+const TCHAR* FNSShotValidator::GetReasonName(ENSShotViolation Reason)
+{
+	switch (Reason) {
+	case ENSShotViolation::RateLimited:
+		return TEXT("RateLimited");
+	case ENSShotViolation::BadDirection:
+		return TEXT("BadDirection");
+	case ENSShotViolation::BadTime:
+		return TEXT("BadTime");
+	case ENSShotViolation::BadOrigin:
+		return TEXT("BadOrigin");
+	default:
+		return TEXT("None");
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorld NSShotViolationsCommand(
+	TEXT("ns.ShotViolations"),
+	TEXT("Logs the recent rejected shots of every player on the server."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		AGameStateBase* thisGameState = World ? World->GetGameState() : nullptr;
+		if (thisGameState == nullptr || World->GetAuthGameMode() == nullptr) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.ShotViolations must run on the server"));
+			return;
+		}
+
+		for (APlayerState* Player : thisGameState->PlayerArray) {
+			ANSPlayerState* thisPS = Cast<ANSPlayerState>(Player);
+			if (thisPS == nullptr || thisPS->GetShotValidator().GetTotalViolations() == 0) {
+				continue;
+			}
+			const FNSShotValidator& Validator = thisPS->GetShotValidator();
+			UE_LOG(LogTemp, Display, TEXT("%s: %d rejected shots"), *thisPS->GetPlayerName(), Validator.GetTotalViolations());
+			for (int32 i = 0; i < Validator.NumViolations(); i++) {
+				const FNSShotViolation& Violation = Validator.GetViolation(i);
+				UE_LOG(LogTemp, Display, TEXT("  %.2f shot %u %s %.2f"), Violation.Time, Violation.ShotId, FNSShotValidator::GetReasonName(Violation.Reason), Violation.Value);
+			}
+		}
+	})
+);
+
+#endif
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** 서버가 발사를 버린 이유 */
+enum class ENSShotViolation : uint8
+{
+	None,
+	RateLimited,
+	BadDirection,
+	BadTime,
+	BadOrigin
+};
+
+/** 위반 기록 하나(12바이트) */
+struct FNSShotViolation
+{
+	float Time;
+	float Value;
+	uint16 ShotId;
+	ENSShotViolation Reason;
+};
+
+/**
+ * 연결마다 하나씩 있는 발사 검증 상태.
+ * 토큰 버킷으로 발사 속도를 제한하고, 버린 발사는 고정 크기 링 버퍼에 남긴다.
+ * 검증은 월드 트레이스 전에 끝나므로 조작된 클라이언트가 쏟아붓는 발사는 트레이스 비용이 없다.
+ */
+class NS_API FNSShotValidator
+{
+public:
+	enum { LogCapacity = 32 };
+
+	FNSShotValidator();
+
+	/**
+	 * 토큰을 하나 쓴다. 토큰은 초당 RatePerSecond개씩 Burst개까지 찬다.
+	 * @return 토큰이 없으면 false
+	 */
+	bool ConsumeToken(float Now, float RatePerSecond, float Burst);
+
+	/** 단위 벡터인지, 서버가 아는 조준 방향에서 너무 벗어나지 않았는지 */
+	static bool IsValidDirection(const FVector& Dir, const FVector& AimDir, float MinAimDot);
+
+	void LogViolation(float Time, uint16 ShotId, ENSShotViolation Reason, float Value);
+
+	/** 오래된 순서로 Index번째 기록 */
+	const FNSShotViolation& GetViolation(int32 Index) const
+	{
+		return Violations[(Head - Count + Index + LogCapacity) % LogCapacity];
+	}
+
+	int32 NumViolations() const { return Count; }
+	int32 GetTotalViolations() const { return TotalViolations; }
+
+	static const TCHAR* GetReasonName(ENSShotViolation Reason);
+
+private:
+	float Tokens;
+	float LastRefillTime;
+
+	FNSShotViolation Violations[LogCapacity];
+	int32 Head;
+	int32 Count;
+	int32 TotalViolations;
+};
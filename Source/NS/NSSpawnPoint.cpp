@@ -2,12 +2,29 @@
 
 #include "NSSpawnPoint.h"
 #include "Components/CapsuleComponent.h"
+#include "NS.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Point Validate"), STAT_NSSpawnPointValidate, STATGROUP_NS);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spawn Points"), STAT_NSSpawnPoints, STATGROUP_NS);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Spawn Overlap Time Saved/Frame (ms)"), STAT_NSSpawnOverlapTimeSaved, STATGROUP_NS);
+
+namespace
+{
+	/** 프레임마다 모든 스폰 지점이 쿼리했다면 들었을 시간을 추정하기 위한 값 */
+	int32 NumSpawnPoints = 0;
+	double AverageValidateSeconds = 0.0;
+}
 
 // Sets default values
 ANSSpawnPoint::ANSSpawnPoint()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// 점유 상태는 오버랩 이벤트로만 추적하므로 틱하지 않는다
+	PrimaryActorTick.bCanEverTick = false;
+
+	//서버만 쓰는 정적 액터라 복제하지 않고 클라이언트는 맵에서 아예 로드하지 않는다
+	bReplicates = false;
+	bNetLoadOnClient = false;
 
 	SpawnCapsule = CreateDefaultSubobject<UCapsuleComponent>(TEXT("Capsule"));
 	SpawnCapsule->SetCollisionProfileName("OverlapAllDynamic");
@@ -21,22 +38,50 @@ ANSSpawnPoint::ANSSpawnPoint()
 void ANSSpawnPoint::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	NumSpawnPoints++;
+	INC_DWORD_STAT(STAT_NSSpawnPoints);
+
+	//게임 모드가 맵을 뒤지지 않도록 직접 등록한다
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	if (thisGameMode) {
+		thisGameMode->RegisterSpawnPoint(this);
+	}
 }
 
-// Called every frame
-void ANSSpawnPoint::Tick(float DeltaTime)
+void ANSSpawnPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	NumSpawnPoints--;
+	DEC_DWORD_STAT(STAT_NSSpawnPoints);
+
+	ANSSGameMode* thisGameMode = Cast<ANSSGameMode>(GetWorld()->GetAuthGameMode());
+	if (thisGameMode) {
+		thisGameMode->UnregisterSpawnPoint(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ANSSpawnPoint::ValidateBlocked()
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSSpawnPointValidate);
+
+	//UpdateOverlaps가 빠진 이벤트를 다시 보내서 OverlappingActors를 맞춰 준다
+	const double StartTime = FPlatformTime::Seconds();
 	SpawnCapsule->UpdateOverlaps();
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+	AverageValidateSeconds = AverageValidateSeconds == 0.0 ? Elapsed : FMath::Lerp(AverageValidateSeconds, Elapsed, 0.1);
+	SET_FLOAT_STAT(STAT_NSSpawnOverlapTimeSaved, AverageValidateSeconds * NumSpawnPoints * 1000.0);
 
+	return GetBlcoked();
 }
 
 void ANSSpawnPoint::OnConstruction(const FTransform& Transform) {
 	if (Team == ETeam::RED_TEAM) {
 		SpawnCapsule->ShapeColor = FColor(255, 0, 0);
 	}
-	else// Team Blue
+	else// Team이 Blue팀
 	{
 		SpawnCapsule->ShapeColor = FColor(0, 0, 255);
 	}
@@ -19,11 +19,9 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	virtual void OnConstruction(const FTransform& Transform) override;
 
 	UFUNCTION()
@@ -35,6 +33,9 @@ public:
 	bool GetBlcoked() {
 		return OverlappingActors.Num() != 0;
 	}
+
+	/** 오버랩 이벤트로 추적한 점유 상태를 실제 오버랩 쿼리로 한 번 더 확인한다. 스폰 지점을 고를 때만 호출 */
+	bool ValidateBlocked();
 	
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 		ETeam Team;
@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSSpawnSelector.h"
+#include "NS.h"
+#include "NSCharacter.h"
+#include "NSPlayerState.h"
+#include "NSSpawnPoint.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Select"), STAT_NSSpawnSelect, STATGROUP_NS);
+DECLARE_CYCLE_STAT(TEXT("Spawn Select Visibility"), STAT_NSSpawnSelectVisibility, STATGROUP_NS);
+
+FNSSpawnSelector::FNSSpawnSelector()
+	: SafeDistance(3000.0f)
+	, DeathMemoryTime(10.0f)
+	, DeathPenalty(0.2f)
+	, VisibilityPenalty(0.5f)
+	, NumVisibilityChecks(4)
+	, NumVisibilityTargets(3)
+	, NumThreats(0)
+	, DeathHead(0)
+	, Random(FPlatformTime::Cycles())
+{
+	for (int32 i = 0; i < NumBuckets; i++) {
+		BucketHead[i] = INDEX_NONE;
+	}
+	for (int32 i = 0; i < MaxDeaths; i++) {
+		DeathTimes[i] = -BIG_NUMBER;
+	}
+}
+
+FIntPoint FNSSpawnSelector::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / SafeDistance), FMath::FloorToInt(Location.Y / SafeDistance));
+}
+
+int32 FNSSpawnSelector::GetBucket(const FIntPoint& Cell) const
+{
+	return ((Cell.X * 73856093) ^ (Cell.Y * 19349663)) & (NumBuckets - 1);
+}
+
+void FNSSpawnSelector::RecordDeath(const FVector& Location, float Time)
+{
+	DeathLocations[DeathHead] = Location;
+	DeathTimes[DeathHead] = Time;
+	DeathHead = (DeathHead + 1) % MaxDeaths;
+}
+
+void FNSSpawnSelector::BuildThreatGrid(const FVector* EnemyLocations, int32 NumEnemies, float Now)
+{
+	for (int32 i = 0; i < NumBuckets; i++) {
+		BucketHead[i] = INDEX_NONE;
+	}
+	NumThreats = 0;
+
+	auto Insert = [this](const FVector& Location, bool bDeath)
+	{
+		const int32 Bucket = GetBucket(GetCell(Location));
+		ThreatLocations[NumThreats] = Location;
+		ThreatIsDeath[NumThreats] = bDeath;
+		ThreatNext[NumThreats] = BucketHead[Bucket];
+		BucketHead[Bucket] = NumThreats;
+		NumThreats++;
+	};
+
+	for (int32 i = 0; i < FMath::Min(NumEnemies, (int32)MaxThreats); i++) {
+		Insert(EnemyLocations[i], false);
+	}
+	for (int32 i = 0; i < MaxDeaths; i++) {
+		if (Now - DeathTimes[i] < DeathMemoryTime) {
+			Insert(DeathLocations[i], true);
+		}
+	}
+}
+
+void FNSSpawnSelector::ScoreCandidates(const FVector* Locations, int32 NumCandidates, float* OutScores) const
+{
+	const float SafeDistanceSquared = SafeDistance * SafeDistance;
+
+	//후보마다 주변 3x3 칸의 위협만 본다. 후보끼리는 독립이라 64개씩 묶어 병렬로 돈다
+	const int32 ChunkSize = 64;
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumCandidates, ChunkSize);
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		const int32 End = FMath::Min(NumCandidates, (Chunk + 1) * ChunkSize);
+		for (int32 Index = Chunk * ChunkSize; Index < End; Index++) {
+			const FVector& Location = Locations[Index];
+			const FIntPoint Cell = GetCell(Location);
+
+			float MinEnemyDistSquared = SafeDistanceSquared;
+			int32 NumDeaths = 0;
+			for (int32 DX = -1; DX <= 1; DX++) {
+				for (int32 DY = -1; DY <= 1; DY++) {
+					const FIntPoint Neighbor(Cell.X + DX, Cell.Y + DY);
+					for (int32 Threat = BucketHead[GetBucket(Neighbor)]; Threat != INDEX_NONE; Threat = ThreatNext[Threat]) {
+						//같은 버킷에 다른 칸이 섞여 있을 수 있다
+						if (GetCell(ThreatLocations[Threat]) != Neighbor) {
+							continue;
+						}
+						const float DistSquared = FVector::DistSquared(Location, ThreatLocations[Threat]);
+						if (DistSquared >= SafeDistanceSquared) {
+							continue;
+						}
+						if (ThreatIsDeath[Threat]) {
+							NumDeaths++;
+						}
+						else {
+							MinEnemyDistSquared = FMath::Min(MinEnemyDistSquared, DistSquared);
+						}
+					}
+				}
+			}
+
+			OutScores[Index] = FMath::Sqrt(MinEnemyDistSquared) / SafeDistance - NumDeaths * DeathPenalty;
+		}
+	}, NumChunks < 2);
+}
+
+int32 FNSSpawnSelector::FindNearest(const FVector& Location, const FVector* Locations, int32 NumLocations, float MaxDistance, int32 MaxResults, int32* OutIndices)
+{
+	MaxResults = FMath::Min(MaxResults, (int32)MaxVisibilityTargets);
+	if (MaxResults <= 0) {
+		return 0;
+	}
+
+	//몇 개만 뽑으니 정렬 대신 작은 배열에 삽입 정렬로 유지한다
+	float DistSquared[MaxVisibilityTargets];
+	int32 NumResults = 0;
+	const float MaxDistSquared = MaxDistance * MaxDistance;
+	for (int32 i = 0; i < NumLocations; i++) {
+		const float ThisDistSquared = FVector::DistSquared(Location, Locations[i]);
+		if (ThisDistSquared > MaxDistSquared || (NumResults == MaxResults && ThisDistSquared >= DistSquared[NumResults - 1])) {
+			continue;
+		}
+		int32 Slot = NumResults < MaxResults ? NumResults++ : NumResults - 1;
+		while (Slot > 0 && DistSquared[Slot - 1] > ThisDistSquared) {
+			DistSquared[Slot] = DistSquared[Slot - 1];
+			OutIndices[Slot] = OutIndices[Slot - 1];
+			Slot--;
+		}
+		DistSquared[Slot] = ThisDistSquared;
+		OutIndices[Slot] = i;
+	}
+	return NumResults;
+}
+
+ANSSpawnPoint* FNSSpawnSelector::Select(UWorld* World, const TArray<ANSSpawnPoint*>& Candidates, ETeam Team, const TArray<ANSCharacter*>& Characters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NSSpawnSelect);
+
+	int32 NumCandidates = 0;
+	for (ANSSpawnPoint* Point : Candidates) {
+		if (NumCandidates >= MaxCandidates) {
+			break;
+		}
+		if (Point->GetBlcoked()) {
+			continue;
+		}
+		CandidatePoints[NumCandidates] = Point;
+		CandidateLocations[NumCandidates] = Point->GetActorLocation();
+		NumCandidates++;
+	}
+	if (NumCandidates == 0) {
+		return nullptr;
+	}
+
+	//살아 있는 적 위치를 모은다
+	FVector EnemyLocations[MaxThreats];
+	int32 NumEnemies = 0;
+	for (ANSCharacter* Character : Characters) {
+		if (NumEnemies >= MaxThreats) {
+			break;
+		}
+		ANSPlayerState* thisPS = Character->GetNSPlayerState();
+		if (Character->CurrentTeam == Team || thisPS == nullptr || thisPS->GetHealth() <= 0) {
+			continue;
+		}
+		EnemyLocations[NumEnemies++] = Character->GetActorLocation();
+	}
+
+	BuildThreatGrid(EnemyLocations, NumEnemies, World->GetTimeSeconds());
+	ScoreCandidates(CandidateLocations, NumCandidates, CandidateScores);
+
+	//점수가 같으면 매번 같은 곳에 나오지 않도록 약간 흔든다
+	bool bChecked[MaxCandidates];
+	for (int32 i = 0; i < NumCandidates; i++) {
+		CandidateScores[i] += Random.FRand() * 0.05f;
+		bChecked[i] = false;
+	}
+
+	int32 NumChecks = 0;
+	for (;;) {
+		int32 Best = INDEX_NONE;
+		for (int32 i = 0; i < NumCandidates; i++) {
+			if (CandidateScores[i] > -BIG_NUMBER && (Best == INDEX_NONE || CandidateScores[i] > CandidateScores[Best])) {
+				Best = i;
+			}
+		}
+		if (Best == INDEX_NONE) {
+			return nullptr;
+		}
+
+		//상위 후보만 가까운 적과의 시야를 확인해서 보이면 점수를 깎고 다시 고른다
+		if (!bChecked[Best] && NumChecks < NumVisibilityChecks) {
+			SCOPE_CYCLE_COUNTER(STAT_NSSpawnSelectVisibility);
+			bChecked[Best] = true;
+			NumChecks++;
+
+			const FVector Eye = CandidateLocations[Best] + FVector(0.0f, 0.0f, 64.0f);
+			int32 Targets[MaxVisibilityTargets];
+			const int32 NumTargets = FindNearest(Eye, EnemyLocations, NumEnemies, SafeDistance * 2.0f, NumVisibilityTargets, Targets);
+			for (int32 i = 0; i < NumTargets; i++) {
+				if (!World->LineTraceTestByChannel(Eye, EnemyLocations[Targets[i]] + FVector(0.0f, 0.0f, 64.0f), ECC_Visibility)) {
+					CandidateScores[Best] -= VisibilityPenalty;
+					break;
+				}
+			}
+			continue;
+		}
+
+		//이벤트로는 비어 보이지만 실제로 막혀 있으면 제외
+		if (CandidatePoints[Best]->ValidateBlocked()) {
+			CandidateScores[Best] = -BIG_NUMBER;
+			continue;
+		}
+		return CandidatePoints[Best];
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommand NSSpawnSelectBenchCommand(
+	TEXT("ns.SpawnSelectBench"),
+	TEXT("Times spawn scoring on random data. Args: [Players=128] [SpawnPoints=256] [Iterations=1000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumPlayers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 128;
+		const int32 NumPoints = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 256;
+		const int32 Iterations = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 1000;
+
+		FRandomStream Stream(1234);
+		TArray<FVector> Enemies;
+		TArray<FVector> Points;
+		TArray<float> Scores;
+		for (int32 i = 0; i < NumPlayers / 2; i++) {
+			Enemies.Add(FVector(Stream.FRandRange(-20000.0f, 20000.0f), Stream.FRandRange(-20000.0f, 20000.0f), 0.0f));
+		}
+		for (int32 i = 0; i < NumPoints; i++) {
+			Points.Add(FVector(Stream.FRandRange(-20000.0f, 20000.0f), Stream.FRandRange(-20000.0f, 20000.0f), 0.0f));
+		}
+		Scores.SetNumZeroed(NumPoints);
+
+		TUniquePtr<FNSSpawnSelector> Selector = MakeUnique<FNSSpawnSelector>();
+		for (int32 i = 0; i < 64; i++) {
+			Selector->RecordDeath(Points[Stream.RandHelper(NumPoints)], 0.0f);
+		}
+
+		int32 Picked = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iter = 0; Iter < Iterations; Iter++) {
+			Selector->BuildThreatGrid(Enemies.GetData(), Enemies.Num(), 1.0f);
+			Selector->ScoreCandidates(Points.GetData(), Points.Num(), Scores.GetData());
+			for (int32 i = 1; i < NumPoints; i++) {
+				if (Scores[i] > Scores[Picked]) {
+					Picked = i;
+				}
+			}
+		}
+		const double Elapsed = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogTemp, Display, TEXT("Spawn scoring: %d enemies, %d spawn points, %.2f us per selection (best %d, visibility traces not included)"),
+			Enemies.Num(), NumPoints, Elapsed * 1000000.0 / Iterations, Picked);
+	})
+);
+
+#endif
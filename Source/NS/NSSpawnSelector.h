@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+class ANSCharacter;
+class ANSSpawnPoint;
+enum class ETeam : uint8;
+
+/**
+ * 스폰 지점 선택기.
+ * 살아 있는 적과 최근 사망 위치를 격자에 담아 두고, 후보 스폰 지점마다 주변 칸만 보고 점수를 매긴다.
+ * 점수가 높은 몇 곳만 적과의 시야를 트레이스로 확인한 뒤 가장 좋은 곳을 고른다.
+ * 작업 버퍼는 미리 잡아 두므로 선택할 때 메모리 할당이 없다.
+ */
+class NS_API FNSSpawnSelector
+{
+public:
+	FNSSpawnSelector();
+
+	/** 사망 위치를 기록한다. 최근 사망이 많은 지점은 점수가 깎인다 */
+	void RecordDeath(const FVector& Location, float Time);
+
+	/**
+	 * Candidates 중 Team에게 가장 안전한 빈 스폰 지점을 고른다.
+	 * @param Characters	서버의 모든 캐릭터. Team이 아닌 살아 있는 캐릭터를 적으로 본다
+	 * @return 빈 지점이 없으면 nullptr
+	 */
+	ANSSpawnPoint* Select(UWorld* World, const TArray<ANSSpawnPoint*>& Candidates, ETeam Team, const TArray<ANSCharacter*>& Characters);
+
+	/**
+	 * 위치만 가지고 점수를 매긴다. Select와 벤치마크가 같이 쓴다.
+	 * 먼저 BuildThreatGrid로 적 위치를 넣어야 한다
+	 */
+	void BuildThreatGrid(const FVector* EnemyLocations, int32 NumEnemies, float Now);
+	void ScoreCandidates(const FVector* Locations, int32 NumCandidates, float* OutScores) const;
+
+	/**
+	 * Location에서 MaxDistance 안에 있는 위치 중 가장 가까운 것부터 최대 MaxResults개(MaxVisibilityTargets까지)의 인덱스를 채운다.
+	 * @return 채운 수
+	 */
+	static int32 FindNearest(const FVector& Location, const FVector* Locations, int32 NumLocations, float MaxDistance, int32 MaxResults, int32* OutIndices);
+
+	/** 이 거리 밖의 적은 위협으로 보지 않는다(격자 칸 크기이기도 하다) */
+	float SafeDistance;
+
+	/** 사망 위치를 기억하는 시간(초) */
+	float DeathMemoryTime;
+
+	/** 사망 하나당 깎는 점수 */
+	float DeathPenalty;
+
+	/** 적에게 보이는 지점에서 깎는 점수 */
+	float VisibilityPenalty;
+
+	/** 시야 트레이스로 확인할 상위 후보 수 */
+	int32 NumVisibilityChecks;
+
+	/** 후보 하나당 시야를 확인할 가장 가까운 적 수(MaxVisibilityTargets까지) */
+	int32 NumVisibilityTargets;
+
+	enum { MaxVisibilityTargets = 8 };
+
+private:
+	enum { NumBuckets = 256, MaxDeaths = 64, MaxThreats = 256, MaxCandidates = 512 };
+
+	int32 GetBucket(const FIntPoint& Cell) const;
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** 격자 해시: 버킷마다 연결 리스트의 머리, 항목마다 다음 인덱스 */
+	int32 BucketHead[NumBuckets];
+	int32 ThreatNext[MaxThreats + MaxDeaths];
+	FVector ThreatLocations[MaxThreats + MaxDeaths];
+	bool ThreatIsDeath[MaxThreats + MaxDeaths];
+	int32 NumThreats;
+
+	FVector DeathLocations[MaxDeaths];
+	float DeathTimes[MaxDeaths];
+	int32 DeathHead;
+
+	/** Select에서 쓰는 작업 버퍼 */
+	FVector CandidateLocations[MaxCandidates];
+	float CandidateScores[MaxCandidates];
+	ANSSpawnPoint* CandidatePoints[MaxCandidates];
+
+	FRandomStream Random;
+};
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSSpawnSelector.h"
+#include "NS.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** 40km 정사각형 맵에 흩어진 위치 */
+	void MakeLocations(FRandomStream& Random, int32 Num, TArray<FVector>& OutLocations)
+	{
+		OutLocations.Reset(Num);
+		for (int32 i = 0; i < Num; i++) {
+			OutLocations.Add(FVector(Random.FRandRange(-20000.0f, 20000.0f), Random.FRandRange(-20000.0f, 20000.0f), 0.0f));
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSSpawnSelectorScoreTest, "NS.SpawnSelector.Score", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNSSpawnSelectorScoreTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1234);
+	TArray<FVector> Enemies;
+	TArray<FVector> Deaths;
+	TArray<FVector> Points;
+	MakeLocations(Random, 64, Enemies);
+	MakeLocations(Random, 32, Deaths);
+	MakeLocations(Random, 256, Points);
+
+	TUniquePtr<FNSSpawnSelector> Selector = MakeUnique<FNSSpawnSelector>();
+	for (const FVector& Death : Deaths) {
+		Selector->RecordDeath(Death, 0.0f);
+	}
+	TArray<float> Scores;
+	Scores.SetNumZeroed(Points.Num());
+	Selector->BuildThreatGrid(Enemies.GetData(), Enemies.Num(), 1.0f);
+	Selector->ScoreCandidates(Points.GetData(), Points.Num(), Scores.GetData());
+
+	//격자 없이 모든 적과 사망 위치를 보는 점수와 같아야 한다
+	const float SafeDistance = Selector->SafeDistance;
+	for (int32 i = 0; i < Points.Num(); i++) {
+		float MinEnemyDist = SafeDistance;
+		for (const FVector& Enemy : Enemies) {
+			MinEnemyDist = FMath::Min(MinEnemyDist, FVector::Dist(Points[i], Enemy));
+		}
+		int32 NumDeaths = 0;
+		for (const FVector& Death : Deaths) {
+			NumDeaths += FVector::Dist(Points[i], Death) < SafeDistance ? 1 : 0;
+		}
+		const float Expected = MinEnemyDist / SafeDistance - NumDeaths * Selector->DeathPenalty;
+		if (!FMath::IsNearlyEqual(Scores[i], Expected, 1e-3f)) {
+			AddError(FString::Printf(TEXT("Spawn point %d scored %f, expected %f"), i, Scores[i], Expected));
+		}
+	}
+
+	//기억 시간이 지난 사망은 점수에 들어가지 않는다
+	Selector->BuildThreatGrid(nullptr, 0, Selector->DeathMemoryTime + 1.0f);
+	Selector->ScoreCandidates(Points.GetData(), Points.Num(), Scores.GetData());
+	for (int32 i = 0; i < Points.Num(); i++) {
+		if (!FMath::IsNearlyEqual(Scores[i], 1.0f, 1e-3f)) {
+			AddError(FString::Printf(TEXT("Spawn point %d scored %f with no threats"), i, Scores[i]));
+			break;
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSSpawnSelectorNearestTest, "NS.SpawnSelector.NearestEnemies", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNSSpawnSelectorNearestTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(5678);
+	TArray<FVector> Enemies;
+	MakeLocations(Random, 128, Enemies);
+	const float MaxDistance = 6000.0f;
+
+	for (int32 Query = 0; Query < 64; Query++) {
+		const FVector Location(Random.FRandRange(-20000.0f, 20000.0f), Random.FRandRange(-20000.0f, 20000.0f), 0.0f);
+
+		//전부 정렬한 결과의 앞부분과 같아야 한다
+		TArray<int32> Sorted;
+		for (int32 i = 0; i < Enemies.Num(); i++) {
+			if (FVector::Dist(Location, Enemies[i]) <= MaxDistance) {
+				Sorted.Add(i);
+			}
+		}
+		Sorted.Sort([&](int32 A, int32 B) { return FVector::DistSquared(Location, Enemies[A]) < FVector::DistSquared(Location, Enemies[B]); });
+
+		int32 Nearest[FNSSpawnSelector::MaxVisibilityTargets];
+		const int32 NumNearest = FNSSpawnSelector::FindNearest(Location, Enemies.GetData(), Enemies.Num(), MaxDistance, 3, Nearest);
+		if (!TestEqual(TEXT("Nearest enemy count"), NumNearest, FMath::Min(Sorted.Num(), 3))) {
+			break;
+		}
+		for (int32 i = 0; i < NumNearest; i++) {
+			TestEqual(FString::Printf(TEXT("Query %d nearest enemy %d"), Query, i), Nearest[i], Sorted[i]);
+		}
+	}
+
+	//최대 개수는 MaxVisibilityTargets로 잘린다
+	int32 Nearest[FNSSpawnSelector::MaxVisibilityTargets];
+	TestEqual(TEXT("Result count is capped"), FNSSpawnSelector::FindNearest(FVector::ZeroVector, Enemies.GetData(), Enemies.Num(), BIG_NUMBER, 100, Nearest), (int32)FNSSpawnSelector::MaxVisibilityTargets);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNSSpawnSelectorBenchTest, "NS.SpawnSelector.Bench128", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FNSSpawnSelectorBenchTest::RunTest(const FString& Parameters)
+{
+	//128명(적 64명), 스폰 지점 256곳. 시야 트레이스는 월드가 필요해서 빠진다
+	const int32 Iterations = 1000;
+	FRandomStream Random(1234);
+	TArray<FVector> Enemies;
+	TArray<FVector> Points;
+	MakeLocations(Random, 64, Enemies);
+	MakeLocations(Random, 256, Points);
+	TArray<float> Scores;
+	Scores.SetNumZeroed(Points.Num());
+
+	TUniquePtr<FNSSpawnSelector> Selector = MakeUnique<FNSSpawnSelector>();
+	for (int32 i = 0; i < 64; i++) {
+		Selector->RecordDeath(Points[Random.RandHelper(Points.Num())], 0.0f);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Iter = 0; Iter < Iterations; Iter++) {
+		Selector->BuildThreatGrid(Enemies.GetData(), Enemies.Num(), 1.0f);
+		Selector->ScoreCandidates(Points.GetData(), Points.Num(), Scores.GetData());
+	}
+	const double PerSelection = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+	AddInfo(FString::Printf(TEXT("Spawn scoring: %.2f us per selection (%d enemies, %d spawn points, visibility traces not included)"), PerSelection, Enemies.Num(), Points.Num()));
+	return true;
+}
+
+#endif
@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSTelemetry.h"
+#include "NS.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+bool FNSTelemetry::bEnabled = false;
+
+namespace
+{
+	/**
+	 * 스레드 하나의 링 버퍼. 쓰는 쪽은 그 스레드 하나, 읽는 쪽은 쓰기 스레드 하나뿐이라 락이 필요 없다.
+	 * 카운터는 부호 없는 값이라 넘쳐도 차이는 맞다.
+	 */
+	struct FNSTelemetryThreadBuffer
+	{
+		enum { Capacity = 8192 };
+
+		FNSTelemetryRecord Records[Capacity];
+		volatile uint32 WriteCount = 0;
+		volatile uint32 ReadCount = 0;
+		volatile uint32 NumDropped = 0;
+	};
+
+	/** 스레드가 끝나도 쓰기 스레드가 남은 레코드를 읽을 수 있도록 버퍼는 지우지 않는다 */
+	TArray<FNSTelemetryThreadBuffer*> ThreadBuffers;
+	FCriticalSection ThreadBuffersLock;
+	uint32 TlsSlot = 0xFFFFFFFF;
+	double StartTime = 0.0;
+
+	/** 스레드 버퍼를 모아 파일에 쓰는 백그라운드 스레드 */
+	class FNSTelemetryWriter : public FRunnable
+	{
+	public:
+		FNSTelemetryWriter(const FString& InDirectory, int64 InMaxFileSize, int32 InMaxFiles, int64 InStartUtcTicks)
+			: Directory(InDirectory)
+			, MaxFileSize(FMath::Max<int64>(InMaxFileSize, sizeof(FNSTelemetryFileHeader) + sizeof(FNSTelemetryRecord)))
+			, MaxFiles(FMath::Max(InMaxFiles, 1))
+			, StartUtcTicks(InStartUtcTicks)
+			, FileStamp(FDateTime::Now().ToString())
+			, File(nullptr)
+			, FileSize(0)
+			, FileIndex(0)
+			, NumWritten(0)
+			, NumDropped(0)
+			, bStopping(false)
+		{
+			WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+			Staging.Reserve(FNSTelemetryThreadBuffer::Capacity * 4);
+		}
+
+		virtual ~FNSTelemetryWriter()
+		{
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping) {
+				WakeEvent->Wait(100);
+				Drain();
+			}
+			Drain();
+			CloseFile();
+			UE_LOG(LogTemp, Display, TEXT("Telemetry: wrote %lld records, dropped %u"), NumWritten, NumDropped);
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+		}
+
+	private:
+		void Drain()
+		{
+			{
+				FScopeLock Lock(&ThreadBuffersLock);
+				Buffers.Reset();
+				Buffers.Append(ThreadBuffers);
+			}
+
+			Staging.Reset();
+			uint32 Dropped = 0;
+			for (FNSTelemetryThreadBuffer* Buffer : Buffers) {
+				const uint32 Read = Buffer->ReadCount;
+				const uint32 Write = Buffer->WriteCount;
+				FPlatformMisc::MemoryBarrier();
+				for (uint32 Count = Read; Count != Write; Count++) {
+					Staging.Add(Buffer->Records[Count & (FNSTelemetryThreadBuffer::Capacity - 1)]);
+				}
+				//다 복사한 뒤에야 생산자가 그 자리를 다시 쓸 수 있다
+				FPlatformMisc::MemoryBarrier();
+				Buffer->ReadCount = Write;
+				Dropped += Buffer->NumDropped;
+			}
+			NumDropped = Dropped;
+
+			//여러 스레드의 레코드가 섞이므로 한 번에 모은 것끼리는 시간순으로 맞춰 쓴다
+			Staging.Sort([](const FNSTelemetryRecord& A, const FNSTelemetryRecord& B) { return A.Time < B.Time; });
+
+			int32 Offset = 0;
+			while (Offset < Staging.Num()) {
+				if (File == nullptr || FileSize + (int64)sizeof(FNSTelemetryRecord) > MaxFileSize) {
+					OpenNextFile();
+					if (File == nullptr) {
+						return;
+					}
+				}
+				const int32 Fit = (int32)FMath::Min<int64>((MaxFileSize - FileSize) / sizeof(FNSTelemetryRecord), Staging.Num() - Offset);
+				File->Serialize(&Staging[Offset], Fit * sizeof(FNSTelemetryRecord));
+				FileSize += Fit * sizeof(FNSTelemetryRecord);
+				NumWritten += Fit;
+				Offset += Fit;
+			}
+			if (File && Staging.Num() > 0) {
+				File->Flush();
+			}
+		}
+
+		void OpenNextFile()
+		{
+			CloseFile();
+
+			const FString FileName = Directory / FString::Printf(TEXT("Telemetry_%s_%03d.nstl"), *FileStamp, FileIndex++);
+			File = IFileManager::Get().CreateFileWriter(*FileName);
+			if (File == nullptr) {
+				UE_LOG(LogTemp, Warning, TEXT("Telemetry: could not open %s"), *FileName);
+				return;
+			}
+
+			FNSTelemetryFileHeader Header;
+			Header.Magic = FNSTelemetryFileHeader::MagicValue;
+			Header.Version = FNSTelemetryFileHeader::CurrentVersion;
+			Header.RecordSize = sizeof(FNSTelemetryRecord);
+			Header.StartUtcTicks = StartUtcTicks;
+			File->Serialize(&Header, sizeof(Header));
+			FileSize = sizeof(Header);
+
+			//오래된 파일은 MaxFiles개만 남긴다
+			FileNames.Add(FileName);
+			while (FileNames.Num() > MaxFiles) {
+				IFileManager::Get().Delete(*FileNames[0]);
+				FileNames.RemoveAt(0);
+			}
+		}
+
+		void CloseFile()
+		{
+			if (File) {
+				File->Close();
+				delete File;
+				File = nullptr;
+			}
+		}
+
+		const FString Directory;
+		const int64 MaxFileSize;
+		const int32 MaxFiles;
+		const int64 StartUtcTicks;
+		const FString FileStamp;
+
+		FArchive* File;
+		int64 FileSize;
+		int32 FileIndex;
+		TArray<FString> FileNames;
+
+		TArray<FNSTelemetryThreadBuffer*> Buffers;
+		TArray<FNSTelemetryRecord> Staging;
+		int64 NumWritten;
+		uint32 NumDropped;
+
+		FEvent* WakeEvent;
+		volatile bool bStopping;
+	};
+
+	FNSTelemetryWriter* Writer = nullptr;
+	FRunnableThread* WriterThread = nullptr;
+}
+
+void FNSTelemetry::StartIfRequested()
+{
+	if (Writer != nullptr || !FParse::Param(FCommandLine::Get(), TEXT("NSTelemetry"))) {
+		return;
+	}
+
+	FString Directory = FPaths::ProjectSavedDir() / TEXT("Telemetry");
+	FParse::Value(FCommandLine::Get(), TEXT("NSTelemetryDir="), Directory);
+	int32 MaxFileSizeMB = 64;
+	FParse::Value(FCommandLine::Get(), TEXT("NSTelemetryFileMB="), MaxFileSizeMB);
+	int32 MaxFiles = 8;
+	FParse::Value(FCommandLine::Get(), TEXT("NSTelemetryMaxFiles="), MaxFiles);
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	if (!FPlatformTLS::IsValidTlsSlot(TlsSlot)) {
+		TlsSlot = FPlatformTLS::AllocTlsSlot();
+	}
+	StartTime = FPlatformTime::Seconds();
+	Writer = new FNSTelemetryWriter(Directory, (int64)MaxFileSizeMB * 1024 * 1024, MaxFiles, FDateTime::UtcNow().GetTicks());
+	WriterThread = FRunnableThread::Create(Writer, TEXT("NSTelemetryWriter"), 0, TPri_BelowNormal);
+	FCoreDelegates::OnPreExit.AddStatic(&FNSTelemetry::Stop);
+	bEnabled = true;
+
+	UE_LOG(LogTemp, Display, TEXT("Telemetry: writing to %s (%d MB x %d files)"), *FPaths::ConvertRelativePathToFull(Directory), MaxFileSizeMB, MaxFiles);
+}
+
+void FNSTelemetry::Stop()
+{
+	if (Writer == nullptr) {
+		return;
+	}
+	bEnabled = false;
+
+	//Kill이 Stop을 부르고 남은 레코드를 다 쓸 때까지 기다린다
+	WriterThread->Kill(true);
+	delete WriterThread;
+	delete Writer;
+	WriterThread = nullptr;
+	Writer = nullptr;
+}
+
+int32 FNSTelemetry::GetPlayerId(const APawn* Pawn)
+{
+	return Pawn && Pawn->PlayerState ? Pawn->PlayerState->PlayerId : -1;
+}
+
+void FNSTelemetry::RecordInternal(ENSTelemetryEvent Type, int32 PlayerId, int32 OtherId, const FVector& Location, float Value, uint16 Aux, uint8 Flags)
+{
+	FNSTelemetryThreadBuffer* Buffer = (FNSTelemetryThreadBuffer*)FPlatformTLS::GetTlsValue(TlsSlot);
+	if (Buffer == nullptr) {
+		//스레드마다 처음 한 번만 버퍼를 만들고 등록한다
+		Buffer = new FNSTelemetryThreadBuffer();
+		FPlatformTLS::SetTlsValue(TlsSlot, Buffer);
+		FScopeLock Lock(&ThreadBuffersLock);
+		ThreadBuffers.Add(Buffer);
+	}
+
+	const uint32 Write = Buffer->WriteCount;
+	if (Write - Buffer->ReadCount >= FNSTelemetryThreadBuffer::Capacity) {
+		Buffer->NumDropped++;
+		return;
+	}
+
+	FNSTelemetryRecord& Record = Buffer->Records[Write & (FNSTelemetryThreadBuffer::Capacity - 1)];
+	Record.Time = (float)(FPlatformTime::Seconds() - StartTime);
+	Record.Type = (uint8)Type;
+	Record.Flags = Flags;
+	Record.Aux = Aux;
+	Record.PlayerId = PlayerId;
+	Record.OtherId = OtherId;
+	Record.X = Location.X;
+	Record.Y = Location.Y;
+	Record.Z = Location.Z;
+	Record.Value = Value;
+
+	//레코드를 다 채운 뒤에 쓰기 스레드에게 보이게 한다
+	FPlatformMisc::MemoryBarrier();
+	Buffer->WriteCount = Write + 1;
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithArgs NSTelemetryBenchCommand(
+	TEXT("ns.TelemetryBench"),
+	TEXT("Times FNSTelemetry::Record on the game thread. Requires -NSTelemetry. Args: [NumEvents=100000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (!FNSTelemetry::IsEnabled()) {
+			UE_LOG(LogTemp, Warning, TEXT("ns.TelemetryBench: run with -NSTelemetry"));
+			return;
+		}
+
+		const int32 NumEvents = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000, 1);
+		const int32 BatchSize = FNSTelemetryThreadBuffer::Capacity / 2;
+		uint32 Cycles = 0;
+		for (int32 Done = 0; Done < NumEvents; Done += BatchSize) {
+			//버퍼가 차서 버리는 경로를 재지 않도록 쓰기 스레드가 비울 때까지 기다린다
+			FPlatformProcess::Sleep(0.2f);
+			const int32 Num = FMath::Min(BatchSize, NumEvents - Done);
+			const uint32 StartCycles = FPlatformTime::Cycles();
+			for (int32 i = 0; i < Num; i++) {
+				FNSTelemetry::Record(ENSTelemetryEvent::Shot, i, -1, FVector::ZeroVector, 0.0f, (uint16)i, 0);
+			}
+			Cycles += FPlatformTime::Cycles() - StartCycles;
+		}
+		UE_LOG(LogTemp, Display, TEXT("ns.TelemetryBench: %d events, %.1f ns/event"), NumEvents, FPlatformTime::ToMilliseconds(Cycles) * 1000000.0 / NumEvents);
+	})
+);
+
+#endif
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APawn;
+
+/** 텔레메트리 이벤트 종류. 파일에 그대로 저장되므로 순서를 바꾸지 않는다 */
+enum class ENSTelemetryEvent : uint8
+{
+	Shot,
+	Hit,
+	Kill,
+	Spawn,
+	RespawnWait,
+
+	Count
+};
+
+/**
+ * 텔레메트리 레코드 하나. 32바이트 고정 크기로 파일에 그대로 쓴다.
+ * Shot: Aux=ShotId, Flags=1이면 검증 통과
+ * Hit: OtherId=가해자, Value=피해량
+ * Kill: OtherId=가해자
+ * Spawn: Flags=1이면 강제 스폰
+ * RespawnWait: Value=큐에서 기다린 시간(초)
+ */
+struct FNSTelemetryRecord
+{
+	/** 세션 시작부터의 시간(초) */
+	float Time;
+	uint8 Type;
+	uint8 Flags;
+	uint16 Aux;
+	int32 PlayerId;
+	int32 OtherId;
+	float X;
+	float Y;
+	float Z;
+	float Value;
+};
+static_assert(sizeof(FNSTelemetryRecord) == 32, "Telemetry records are written to disk as is");
+
+/** 텔레메트리 파일 머리. 레코드 앞에 한 번 쓴다 */
+struct FNSTelemetryFileHeader
+{
+	enum { MagicValue = 0x4C54534E, CurrentVersion = 1 }; // 'NSTL'
+
+	uint32 Magic;
+	uint16 Version;
+	uint16 RecordSize;
+
+	/** 세션 시작 시각(UTC, FDateTime 틱). 레코드의 Time은 여기서부터 잰다 */
+	int64 StartUtcTicks;
+};
+static_assert(sizeof(FNSTelemetryFileHeader) == 16, "Telemetry file header is written to disk as is");
+
+/**
+ * 매치 텔레메트리.
+ * -NSTelemetry로 실행한 서버에서만 켜진다. 이벤트를 부른 스레드마다 고정 크기 링 버퍼가 있어서 기록할 때 락이 없고,
+ * 백그라운드 스레드가 주기적으로 모아 Saved/Telemetry/ 아래 파일에 쓴다. 파일이 MaxFileSize를 넘으면 새 파일로 넘어가고
+ * 오래된 파일은 MaxFiles개만 남긴다. 버퍼가 가득 차면 레코드를 버리고 개수만 센다.
+ * 읽을 때는 NSTelemetryToCsv 커맨드렛으로 CSV로 바꾼다.
+ */
+class NS_API FNSTelemetry
+{
+public:
+	/** 명령줄에 -NSTelemetry가 있으면 쓰기 스레드를 시작한다. 여러 번 불러도 된다 */
+	static void StartIfRequested();
+
+	/** 남은 레코드를 모두 쓰고 스레드를 멈춘다. 종료 시 자동으로 불린다 */
+	static void Stop();
+
+	static bool IsEnabled() { return bEnabled; }
+
+	/** 꺼져 있으면 아무것도 하지 않는다. 어느 스레드에서나 부를 수 있다 */
+	static FORCEINLINE void Record(ENSTelemetryEvent Type, int32 PlayerId, int32 OtherId, const FVector& Location, float Value = 0.0f, uint16 Aux = 0, uint8 Flags = 0)
+	{
+		if (bEnabled) {
+			RecordInternal(Type, PlayerId, OtherId, Location, Value, Aux, Flags);
+		}
+	}
+
+	/** 폰의 PlayerId. 플레이어 상태가 없으면 -1 */
+	static int32 GetPlayerId(const APawn* Pawn);
+
+private:
+	static void RecordInternal(ENSTelemetryEvent Type, int32 PlayerId, int32 OtherId, const FVector& Location, float Value, uint16 Aux, uint8 Flags);
+
+	static bool bEnabled;
+};
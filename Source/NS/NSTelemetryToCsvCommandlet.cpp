@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSTelemetryToCsvCommandlet.h"
+#include "NSTelemetry.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Templates/UniquePtr.h"
+
+namespace
+{
+	/** 한 번에 읽어 들이는 레코드 수. 이만큼 쓸 때마다 출력도 비운다 */
+	const int32 RecordsPerChunk = 4096;
+
+	void WriteLine(FArchive& Out, const FString& Line)
+	{
+		FTCHARToUTF8 Utf8(*Line);
+		Out.Serialize((void*)Utf8.Get(), Utf8.Length());
+	}
+}
+
+UNSTelemetryToCsvCommandlet::UNSTelemetryToCsvCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNSTelemetryToCsvCommandlet::Main(const FString& Params)
+{
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("In="), InPath)) {
+		UE_LOG(LogTemp, Error, TEXT("Usage: -run=NSTelemetryToCsv -In=<file.nstl or directory> [-Out=<file.csv>]"));
+		return 1;
+	}
+
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*InPath)) {
+		IFileManager::Get().FindFiles(Files, *(InPath / TEXT("*.nstl")), true, false);
+		Files.Sort();
+		for (FString& File : Files) {
+			File = InPath / File;
+		}
+	}
+	else {
+		Files.Add(InPath);
+	}
+
+	FString OutPath;
+	if (!FParse::Value(*Params, TEXT("Out="), OutPath)) {
+		OutPath = IFileManager::Get().DirectoryExists(*InPath) ? InPath / TEXT("Telemetry.csv") : FPaths::ChangeExtension(InPath, TEXT("csv"));
+	}
+
+	//긴 매치의 로그도 메모리에 다 올리지 않도록 읽는 대로 파일에 흘려 쓴다
+	TUniquePtr<FArchive> Out(IFileManager::Get().CreateFileWriter(*OutPath));
+	if (!Out) {
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *OutPath);
+		return 1;
+	}
+	WriteLine(*Out, TEXT("time_s,event,player,other,x,y,z,value,aux,flags\n"));
+
+	int32 NumRecords = 0;
+	for (const FString& File : Files) {
+		if (!AppendFile(File, *Out, NumRecords)) {
+			return 1;
+		}
+	}
+
+	if (!Out->Close()) {
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *OutPath);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Wrote %d records from %d files to %s"), NumRecords, Files.Num(), *OutPath);
+	return 0;
+}
+
+bool UNSTelemetryToCsvCommandlet::AppendFile(const FString& Path, FArchive& Out, int32& OutNumRecords) const
+{
+	static const TCHAR* EventNames[] = { TEXT("Shot"), TEXT("Hit"), TEXT("Kill"), TEXT("Spawn"), TEXT("RespawnWait") };
+	static_assert(ARRAY_COUNT(EventNames) == (int32)ENSTelemetryEvent::Count, "Add a name for each telemetry event");
+
+	TUniquePtr<FArchive> In(IFileManager::Get().CreateFileReader(*Path));
+	if (!In) {
+		UE_LOG(LogTemp, Error, TEXT("Could not read %s"), *Path);
+		return false;
+	}
+
+	FNSTelemetryFileHeader Header;
+	if (In->TotalSize() < (int64)sizeof(Header)) {
+		UE_LOG(LogTemp, Error, TEXT("%s is not a telemetry file"), *Path);
+		return false;
+	}
+	In->Serialize(&Header, sizeof(Header));
+	if (Header.Magic != FNSTelemetryFileHeader::MagicValue || Header.Version != FNSTelemetryFileHeader::CurrentVersion || Header.RecordSize != sizeof(FNSTelemetryRecord)) {
+		UE_LOG(LogTemp, Error, TEXT("%s: unsupported telemetry file (version %d, record size %d)"), *Path, Header.Version, Header.RecordSize);
+		return false;
+	}
+
+	//쓰다가 끊긴 파일이면 마지막 불완전한 레코드는 버린다
+	const int64 NumRecords = (In->TotalSize() - (int64)sizeof(Header)) / (int64)sizeof(FNSTelemetryRecord);
+	TArray<FNSTelemetryRecord> Chunk;
+	FString Line;
+	for (int64 First = 0; First < NumRecords; First += RecordsPerChunk) {
+		const int32 Count = (int32)FMath::Min<int64>(RecordsPerChunk, NumRecords - First);
+		Chunk.SetNumUninitialized(Count, false);
+		In->Serialize(Chunk.GetData(), Count * sizeof(FNSTelemetryRecord));
+		if (In->IsError()) {
+			UE_LOG(LogTemp, Error, TEXT("Could not read %s"), *Path);
+			return false;
+		}
+
+		for (const FNSTelemetryRecord& Record : Chunk) {
+			const TCHAR* EventName = Record.Type < ARRAY_COUNT(EventNames) ? EventNames[Record.Type] : TEXT("Unknown");
+			Line = FString::Printf(TEXT("%.4f,%s,%d,%d,%.1f,%.1f,%.1f,%.3f,%u,%u\n"),
+				Record.Time, EventName, Record.PlayerId, Record.OtherId, Record.X, Record.Y, Record.Z, Record.Value, (uint32)Record.Aux, (uint32)Record.Flags);
+			WriteLine(Out, Line);
+		}
+		Out.Flush();
+	}
+	OutNumRecords += (int32)NumRecords;
+	return true;
+}
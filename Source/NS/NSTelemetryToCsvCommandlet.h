@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NSTelemetryToCsvCommandlet.generated.h"
+
+/**
+ * 텔레메트리 파일을 CSV로 바꾼다.
+ * UE4Editor-Cmd NS -run=NSTelemetryToCsv -In=<.nstl 파일 또는 폴더> [-Out=<csv 경로>]
+ * 폴더를 주면 안의 .nstl 파일을 이름 순서로 모두 이어 붙인다. -Out이 없으면 입력 옆에 .csv로 쓴다.
+ */
+UCLASS()
+class UNSTelemetryToCsvCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UNSTelemetryToCsvCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** 파일 하나를 조금씩 읽어 Out에 줄을 바로 쓴다. 머리가 맞지 않으면 false */
+	bool AppendFile(const FString& Path, FArchive& Out, int32& OutNumRecords) const;
+};
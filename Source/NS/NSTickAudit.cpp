@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NSTickAudit.h"
+#include "NS.h"
+#include "UObject/Class.h"
+
+#if !UE_BUILD_SHIPPING
+
+bool FNSTickAudit::bRecording = false;
+
+namespace
+{
+	struct FNSTickCost
+	{
+		int32 Count = 0;
+		uint64 Cycles = 0;
+		uint32 MaxCycles = 0;
+	};
+
+	/** 클래스는 재는 동안 사라지지 않으니 포인터를 키로 쓴다 */
+	TMap<const UClass*, FNSTickCost> TickCosts;
+}
+
+void FNSTickAudit::Begin()
+{
+	TickCosts.Reset();
+	bRecording = true;
+}
+
+void FNSTickAudit::End(int32 Frames)
+{
+	if (!bRecording) {
+		return;
+	}
+	bRecording = false;
+
+	TickCosts.ValueSort([](const FNSTickCost& A, const FNSTickCost& B) { return A.Cycles > B.Cycles; });
+	const double MsPerCycle = FPlatformTime::GetSecondsPerCycle() * 1000.0;
+	const int32 NumFrames = FMath::Max(Frames, 1);
+	UE_LOG(LogTemp, Display, TEXT("%-40s %8s %10s %10s %10s"), TEXT("NS tick cost by class"), TEXT("Ticks"), TEXT("ms/frame"), TEXT("avg ms"), TEXT("max ms"));
+	for (const auto& Pair : TickCosts) {
+		const FNSTickCost& Cost = Pair.Value;
+		UE_LOG(LogTemp, Display, TEXT("%-40s %8d %10.3f %10.4f %10.4f"), *Pair.Key->GetName(), Cost.Count,
+			Cost.Cycles * MsPerCycle / NumFrames, Cost.Cycles * MsPerCycle / Cost.Count, Cost.MaxCycles * MsPerCycle);
+	}
+	TickCosts.Reset();
+}
+
+void FNSTickAudit::Record(const UObject* Object, uint32 Cycles)
+{
+	//게임 스레드 틱만 모은다
+	if (!IsInGameThread()) {
+		return;
+	}
+	FNSTickCost& Cost = TickCosts.FindOrAdd(Object->GetClass());
+	Cost.Count++;
+	Cost.Cycles += Cycles;
+	Cost.MaxCycles = FMath::Max(Cost.MaxCycles, Cycles);
+}
+
+#endif
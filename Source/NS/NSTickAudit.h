@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * ns.TickAudit가 재는 동안 NS 액터의 Tick 한 번 한 번에 걸린 시간을 클래스별로 모은다.
+ * 엔진 클래스의 틱 함수 안에는 끼어들 수 없어서 그쪽은 목록과 전체 틱 구간 시간만 나온다.
+ */
+class NS_API FNSTickAudit
+{
+public:
+	static bool IsRecording() { return bRecording; }
+
+	static void Begin();
+
+	/** 모은 시간을 클래스별로 남기고 기록을 멈춘다. 재는 중이 아니면 아무것도 하지 않는다 */
+	static void End(int32 Frames);
+
+	static void Record(const UObject* Object, uint32 Cycles);
+
+private:
+	static bool bRecording;
+};
+
+/** 틱 하나의 시간을 잰다. 재는 중이 아니면 bool 하나만 읽는다 */
+struct FNSTickAuditScope
+{
+	const UObject* const Object;
+	const uint32 StartCycles;
+
+	explicit FNSTickAuditScope(const UObject* InObject)
+		: Object(FNSTickAudit::IsRecording() ? InObject : nullptr)
+		, StartCycles(Object ? FPlatformTime::Cycles() : 0)
+	{
+	}
+
+	~FNSTickAuditScope()
+	{
+		if (Object) {
+			FNSTickAudit::Record(Object, FPlatformTime::Cycles() - StartCycles);
+		}
+	}
+};
+
+/** NS 액터의 Tick 첫 줄에 둔다 */
+#define NS_TICK_AUDIT_SCOPE() FNSTickAuditScope NSTickAuditScope(this)
+
+#else
+
+#define NS_TICK_AUDIT_SCOPE()
+
+#endif